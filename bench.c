@@ -0,0 +1,368 @@
+/********************************************************************
+ *  bench.c ― 오프라인 탐색 벤치마크 (서버 접속 없이)
+ *
+ *  국면 파일을 읽어 각 엔진을 고정 깊이 또는 고정 시간으로 돌리고
+ *  노드 수, 초당 노드, 끝낸 깊이, 깊이별 도달 시간, 최선 수와 점수를
+ *  표(stdout)와 JSON(-json)으로 출력한다.
+ *
+ *  빌드:
+ *      gcc bench.c engine.c nnue.c book.c cache.c -o bench -O2 -Wall -Wextra -lm -pthread
+ *    client4 엔진도 함께 (client4.o 는 LED 프로젝트의 보드 헤더로 빌드):
+ *      gcc -DBENCH_CLIENT4 bench.c client4.o led_sim.c engine.c nnue.c book.c cache.c -o bench -O2 -Wall -Wextra -lm -pthread
+ *    (LED 는 led_sim.c 가 메모리에 그린다.  -led-delay <us> 로 느린 드라이버 흉내)
+ *
+ *  실행 예:
+ *      ./bench -depth 6 bench_positions.txt
+ *      ./bench -time 2.9 -threads 4 -json result.json bench_positions.txt
+ *      ./bench -depth 8 -eval octaflip.nn bench_positions.txt    (client2 만)
+ *      ./bench -time 1 -mcts -threads 4 bench_positions.txt      (client2 만)
+ *  -mcts 면 nodes 는 playout 수, depth 는 나무 깊이다.  -time 없이 돌리면
+ *  노드 arena(-hash) 가 찰 때까지 읽는다.
+ *  고정 시간 (α-β) 이면 빈칸이 endgame_empties 이하인 국면이 종반 solver 로
+ *  풀렸는지도 검사해, 못 푼 국면이 있으면 stderr 에 적고 종료 코드 1.
+ *
+ *  국면 파일: 한 줄에 한 국면 — 보드 SIZE 줄을 '/' 로 이은 문자열, 둘 차례,
+ *  (선택) 이름.  R/B = 말, '.' = 빈칸, 그 밖의 문자 = 막힌 칸.
+ *  '#' 로 시작하는 줄은 주석.
+ *      R......B/......../......../......../......../......../......../B......R R start
+ *******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "engine.h"
+
+#define MAX_POSITIONS 256
+
+typedef struct {
+    char name[32];
+    char board[SIZE][SIZE];
+    char me;
+} BenchPos;
+
+typedef struct {
+    const char *engine;
+    const char *name;
+    int      depth;                 /* 끝낸 깊이 (종반 solver 로 풀었으면 0) */
+    int      empties;
+    int      solved;                /* EngineResult.solved (client2 만) */
+    uint64_t nodes;
+    double   time;
+    int      r1, c1, r2, c2;        /* 0부터, 패스면 r1 < 0 */
+    int      score;
+    int      iter_cnt;
+    int      iter_depth[MAX_PLY];
+    double   iter_time[MAX_PLY];
+} BenchResult;
+
+/* ───── 인자 파싱 ─────────────────────────────────────────────────── */
+static void bench_usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-depth <N> | -time <sec>] [-engine 2|4|all]"
+            " [-threads <N>] [-hash <MB>] [-eval <weights>] [-book <file>] [-cache <file>] [-mcts] [-json <file>]"
+            " [-led-delay <us>]"
+            " <positions>\n",
+            prog);
+    exit(EXIT_FAILURE);
+}
+
+/* ───── 국면 파일 읽기 ───────────────────────────────────────────── */
+static int load_positions(const char *path, BenchPos *out, int max)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror("[Bench] open positions");
+        exit(EXIT_FAILURE);
+    }
+    char line[512];
+    int n = 0, lineno = 0;
+    while (n < max && fgets(line, sizeof(line), fp)) {
+        ++lineno;
+        char board[128], side[8], name[32] = "";
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (sscanf(line, "%127s %7s %31s", board, side, name) < 2) {
+            fprintf(stderr, "[Bench] %s:%d: malformed line, ignored\n", path, lineno);
+            continue;
+        }
+        BenchPos *p = &out[n];
+        int cells = 0;
+        for (const char *c = board; *c && cells <= NSQ; ++c) {
+            if (*c == '/') continue;
+            if (cells < NSQ) p->board[cells / SIZE][cells % SIZE] = *c;
+            ++cells;
+        }
+        if (cells != NSQ || (side[0] != 'R' && side[0] != 'B')) {
+            fprintf(stderr, "[Bench] %s:%d: need %d cells and side R|B, ignored\n",
+                    path, lineno, NSQ);
+            continue;
+        }
+        p->me = side[0];
+        if (name[0]) snprintf(p->name, sizeof(p->name), "%s", name);
+        else         snprintf(p->name, sizeof(p->name), "pos%d", n + 1);
+        ++n;
+    }
+    fclose(fp);
+    return n;
+}
+
+static int count_empties(const BenchPos *bp)
+{
+    int n = 0;
+    for (int r = 0; r < SIZE; ++r)
+        for (int c = 0; c < SIZE; ++c)
+            n += bp->board[r][c] == '.';
+    return n;
+}
+
+/* ───── client2 엔진 ─────────────────────────────────────────────── */
+static Engine *engine2;
+
+static void run_client2(BenchPos *bp, int depth, double secs, BenchResult *res)
+{
+    // 국면끼리 서로 영향이 없도록 치환표·history 를 비운다
+    engine_clear(engine2);
+
+    EngineConfig *cfg = engine_config(engine2);
+    EngineResult er;
+    if (depth > 0) {
+        // 고정 깊이: 마감 없이 depth 까지 반복 심화 (종반 solver 는 쓰지 않음)
+        cfg->max_depth = depth;
+        cfg->endgame_empties = 0;
+        engine_search(engine2, bp->board, bp->me, INFINITY, &er);
+    } else {
+        // 고정 시간: 실제 클라이언트와 같은 경로 (시간 관리·종반 solver 포함)
+        EngineConfig def = ENGINE_CONFIG_DEFAULT;
+        cfg->max_depth = def.max_depth;
+        cfg->endgame_empties = def.endgame_empties;
+        engine_search(engine2, bp->board, bp->me, secs, &er);
+    }
+    res->engine = "client2";
+    res->solved = er.solved;
+    res->r1 = er.move.r1; res->c1 = er.move.c1;
+    res->r2 = er.move.r2; res->c2 = er.move.c2;
+    res->time  = er.time;
+    res->depth = er.depth;
+    res->score = er.score;
+    res->nodes = er.nodes;
+    res->iter_cnt = er.iter_cnt;
+    for (int i = 0; i < res->iter_cnt; ++i) {
+        res->iter_depth[i] = er.iters[i].depth;
+        res->iter_time[i]  = er.iters[i].time;
+    }
+}
+
+/* ───── client4 엔진 (선택) ──────────────────────────────────────── */
+#ifdef BENCH_CLIENT4
+#include "led_sim.h"
+
+extern int      client4_max_depth;
+extern double   client4_time_limit;
+extern uint64_t client4_nodes;
+extern int      client4_depth;
+extern int      client4_score;
+extern double   client4_depth_time[];
+
+int generate_move(char board[SIZE][SIZE], char player_color,
+                  int *out_r1, int *out_c1, int *out_r2, int *out_c2);
+void client4_shutdown(void);
+
+
+static void run_client4(BenchPos *bp, int depth, double secs, BenchResult *res)
+{
+    static int default_depth = -1;
+    if (default_depth < 0) default_depth = client4_max_depth;
+    client4_max_depth  = depth > 0 ? depth : default_depth;
+    client4_time_limit = depth > 0 ? HUGE_VAL : secs;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int moved = generate_move(bp->board, bp->me,
+                              &res->r1, &res->c1, &res->r2, &res->c2);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (!moved) res->r1 = res->c1 = res->r2 = res->c2 = -1;
+
+    res->engine = "client4";
+    res->time   = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    res->depth  = client4_depth;
+    res->score  = client4_score;
+    res->nodes  = client4_nodes;
+    res->iter_cnt = client4_depth;
+    for (int d = 1; d <= client4_depth; ++d) {
+        res->iter_depth[d - 1] = d;
+        res->iter_time[d - 1]  = client4_depth_time[d];
+    }
+}
+#endif
+
+/* ───── 출력 ─────────────────────────────────────────────────────── */
+static void format_move(const BenchResult *r, char *buf, size_t len)
+{
+    if (r->r1 < 0) snprintf(buf, len, "pass");
+    else snprintf(buf, len, "(%d,%d)->(%d,%d)",
+                  r->r1 + 1, r->c1 + 1, r->r2 + 1, r->c2 + 1);
+}
+
+static void print_table(const BenchResult *res, int n)
+{
+    printf("\n%-8s %-16s %5s %12s %10s %8s %-16s %8s  %s\n",
+           "engine", "position", "depth", "nodes", "knps", "time", "move",
+           "score", "time to depth");
+    uint64_t total_nodes = 0;
+    double total_time = 0;
+    for (int i = 0; i < n; ++i) {
+        const BenchResult *r = &res[i];
+        char mv[64];
+        format_move(r, mv, sizeof(mv));
+        printf("%-8s %-16s %5d %12llu %10.0f %8.3f %-16s %8d ",
+               r->engine, r->name, r->depth, (unsigned long long)r->nodes,
+               r->time > 0 ? r->nodes / r->time / 1000 : 0, r->time, mv, r->score);
+        for (int k = 0; k < r->iter_cnt; ++k)
+            printf(" %d:%.3f", r->iter_depth[k], r->iter_time[k]);
+        putchar('\n');
+        total_nodes += r->nodes;
+        total_time  += r->time;
+    }
+    printf("total nodes %llu, time %.3f s, %.0f knps\n",
+           (unsigned long long)total_nodes, total_time,
+           total_time > 0 ? total_nodes / total_time / 1000 : 0);
+}
+
+static void write_json(const char *path, const BenchResult *res, int n,
+                       int depth, double secs, int threads)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        perror("[Bench] open json");
+        return;
+    }
+    fprintf(fp, "{\"mode\":\"%s\",\"limit\":%g,\"threads\":%d,\"results\":[",
+            depth > 0 ? "depth" : "time", depth > 0 ? (double)depth : secs,
+            threads);
+    for (int i = 0; i < n; ++i) {
+        const BenchResult *r = &res[i];
+        char mv[64];
+        format_move(r, mv, sizeof(mv));
+        fprintf(fp, "%s\n{\"engine\":\"%s\",\"position\":\"%s\",\"depth\":%d,"
+                "\"nodes\":%llu,\"nps\":%.0f,\"time\":%.6f,\"move\":\"%s\","
+                "\"score\":%d,\"iterations\":[",
+                i ? "," : "", r->engine, r->name, r->depth,
+                (unsigned long long)r->nodes,
+                r->time > 0 ? r->nodes / r->time : 0, r->time, mv, r->score);
+        for (int k = 0; k < r->iter_cnt; ++k)
+            fprintf(fp, "%s{\"depth\":%d,\"time\":%.6f}", k ? "," : "",
+                    r->iter_depth[k], r->iter_time[k]);
+        fprintf(fp, "]}");
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+}
+
+int main(int argc, char *argv[])
+{
+    int depth = 0;
+    double secs = 3.0;
+    EngineConfig cfg = ENGINE_CONFIG_DEFAULT;
+    const char *engine = "all", *json = NULL, *path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-depth") == 0) {
+            depth = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-time") == 0) {
+            secs = atof(argv[++i]);
+            depth = 0;
+        } else if (i + 1 < argc && strcmp(argv[i], "-engine") == 0) {
+            engine = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-threads") == 0) {
+            cfg.threads = atoi(argv[++i]);
+            if (cfg.threads < 1 || cfg.threads > MAX_THREADS) bench_usage(argv[0]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-hash") == 0) {
+            cfg.hash_mb = strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-eval") == 0) {
+            cfg.eval_file = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-book") == 0) {
+            cfg.book_file = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-cache") == 0) {
+            cfg.cache_file = argv[++i];
+        } else if (strcmp(argv[i], "-mcts") == 0) {
+            cfg.mcts = 1;
+        } else if (i + 1 < argc && strcmp(argv[i], "-json") == 0) {
+            json = argv[++i];
+#ifdef BENCH_CLIENT4
+        } else if (i + 1 < argc && strcmp(argv[i], "-led-delay") == 0) {
+            led_sim_delay_us = atol(argv[++i]);
+#endif
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            bench_usage(argv[0]);
+        }
+    }
+    if (!path || depth < 0 || depth >= MAX_PLY || cfg.hash_mb == 0) bench_usage(argv[0]);
+
+    static BenchPos positions[MAX_POSITIONS];
+    int npos = load_positions(path, positions, MAX_POSITIONS);
+    if (npos == 0) {
+        fprintf(stderr, "[Bench] no positions in %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    int run2 = strcmp(engine, "4") != 0;
+    int run4 = strcmp(engine, "2") != 0;
+#ifndef BENCH_CLIENT4
+    if (run4 && strcmp(engine, "all") != 0) {
+        fprintf(stderr, "[Bench] built without client4 (-DBENCH_CLIENT4)\n");
+        return EXIT_FAILURE;
+    }
+    run4 = 0;
+#endif
+    if (run2 && !(engine2 = engine_create(&cfg))) {
+        fprintf(stderr, "[Bench] engine init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    static BenchResult results[2 * MAX_POSITIONS];
+    int nres = 0;
+    for (int i = 0; i < npos; ++i) {
+        if (run2) {
+            results[nres].name = positions[i].name;
+            results[nres].empties = count_empties(&positions[i]);
+            run_client2(&positions[i], depth, secs, &results[nres++]);
+        }
+#ifdef BENCH_CLIENT4
+        if (run4) {
+            results[nres].name = positions[i].name;
+            run_client4(&positions[i], depth, secs, &results[nres++]);
+        }
+#endif
+    }
+
+    print_table(results, nres);
+#ifdef BENCH_CLIENT4
+    // 렌더러 스레드는 뒤처진 프레임을 건너뛰므로 그린 수 ≤ 국면 수.
+    // 남은 프레임까지 그리고 스레드를 join 한 뒤에 센다
+    if (run4) client4_shutdown();
+    uint64_t frames = atomic_load(&led_sim_frames);
+    if (run4)
+        printf("LED frames drawn %llu, avg %.3f ms in update_led_matrix\n",
+               (unsigned long long)frames,
+               frames ? atomic_load(&led_sim_busy_ns) / 1e6 / frames : 0);
+#endif
+    if (json) write_json(json, results, nres, depth, secs, cfg.threads);
+    // 고정 시간이면 solver 범위 안의 국면은 증명돼야 한다 (bench 국면은 그렇게 골랐다)
+    int unsolved = 0;
+    for (int i = 0; depth == 0 && !cfg.mcts && i < nres; ++i) {
+        const BenchResult *r = &results[i];
+        if (strcmp(r->engine, "client2") != 0 || r->solved) continue;
+        if (r->empties > cfg.endgame_empties) continue;
+        fprintf(stderr, "[Bench] %s: %d empties but not solved by the endgame solver\n",
+                r->name, r->empties);
+        ++unsolved;
+    }
+    return unsolved ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,131 @@
+/********************************************************************
+ *  book.c ― opening book 파일: mmap, 이진 탐색, 쓰기
+ *
+ *  빌드 (engine.c 와 함께):
+ *      gcc -c book.c -O2 -Wall -Wextra [-DOCTAFLIP_SIZE=N]
+ *******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "book.h"
+
+struct Book {
+    void            *map;
+    size_t           len;
+    const BookEntry *entries;
+    uint64_t         count;
+};
+
+/* ───── 열기·닫기 ────────────────────────────────────────────────── */
+Book *book_open(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("[Book] open");
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(BookHeader)) {
+        fprintf(stderr, "[Book] %s: not a book file\n", path);
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("[Book] mmap");
+        return NULL;
+    }
+
+    const BookHeader *h = map;
+    const char *why = NULL;
+    if (h->magic != BOOK_MAGIC)
+        why = "not a book file";
+    else if (h->version != BOOK_VERSION || h->size != SIZE
+             || h->entry_size != sizeof(BookEntry))
+        why = "built for another version or board size";
+    else if (h->count > (st.st_size - sizeof(BookHeader)) / sizeof(BookEntry))
+        why = "truncated";
+    Book *book = why ? NULL : malloc(sizeof(Book));
+    if (!book) {
+        fprintf(stderr, "[Book] %s: %s\n", path, why ? why : "out of memory");
+        munmap(map, st.st_size);
+        return NULL;
+    }
+    book->map     = map;
+    book->len     = st.st_size;
+    book->entries = (const BookEntry *)(h + 1);
+    book->count   = h->count;
+    // 탐색은 log2(count) 번 건드리는 게 전부지만, 첫 수부터 page fault 없이
+    posix_madvise(map, st.st_size, POSIX_MADV_WILLNEED);
+    return book;
+}
+
+void book_close(Book *book)
+{
+    if (!book) return;
+    munmap(book->map, book->len);
+    free(book);
+}
+
+uint64_t book_count(const Book *book) { return book->count; }
+
+/* ───── 찾기 ────────────────────────────────────────────────────── */
+int book_probe(const Book *book, const Pos *p, int side,
+               int *from, int *to, int *score, int *depth)
+{
+    Pos canon;
+    int sym = pos_canonical(p, side, &canon);
+    uint64_t key = canon_key(&canon);
+
+    uint64_t lo = 0, hi = book->count;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (book->entries[mid].key < key) lo = mid + 1;
+        else                               hi = mid;
+    }
+    if (lo == book->count || book->entries[lo].key != key) return 0;
+
+    const BookEntry *e = &book->entries[lo];
+    int f = e->move & 0xFF, t = e->move >> 8;
+    if (f >= NSQ || t >= NSQ) return 0;
+    f = sq_transform(f, sym_inverse(sym));
+    t = sq_transform(t, sym_inverse(sym));
+    // key 충돌이면 수가 맞지 않는다: 내 말에서 1~2칸, 빈칸으로
+    if (!(p->bb[side] & BB_SQ(f)) || !((ADJ[f] | JUMP[f]) & empty_bb(p) & BB_SQ(t)))
+        return 0;
+    *from  = f;
+    *to    = t;
+    *score = e->score;
+    *depth = e->depth;
+    return 1;
+}
+
+/* ───── 쓰기 ────────────────────────────────────────────────────── */
+static int cmp_entry(const void *a, const void *b)
+{
+    const BookEntry *x = a, *y = b;
+    return x->key < y->key ? -1 : x->key > y->key;
+}
+
+int book_write(const char *path, BookEntry *entries, uint64_t count)
+{
+    qsort(entries, count, sizeof(BookEntry), cmp_entry);
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        perror("[Book] open for write");
+        return -1;
+    }
+    BookHeader h = { BOOK_MAGIC, BOOK_VERSION, SIZE, sizeof(BookEntry), count };
+    int ok = fwrite(&h, sizeof(h), 1, fp) == 1
+          && fwrite(entries, sizeof(BookEntry), count, fp) == count;
+    if (fclose(fp) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,55 @@
+/********************************************************************
+ *  book.h ― 미리 계산한 opening book (mmap + 이진 탐색)
+ *
+ *  book_build.c 가 시작 국면에서 N 수까지 나오는 국면을 모두 깊게
+ *  탐색해 최선 수를 파일로 남기고, 엔진은 시작할 때 파일을 mmap 해
+ *  engine_search 첫머리에서 찾아본다.  있으면 탐색 없이 바로 둔다.
+ *
+ *  국면은 pos_canonical 정규형으로 저장하므로 대칭·색을 바꾼 국면이
+ *  항목 하나를 나눠 쓴다.  수도 정규형 방향으로 저장하고, 찾을 때
+ *  sym_inverse 로 되돌린 뒤 합법인지 한 번 더 확인한다 (key 충돌 대비).
+ *
+ *  파일 (little endian, 항목은 key 오름차순):
+ *      BookHeader { magic "OFBK", version, size, entry_size, count }
+ *      BookEntry  [count]
+ *******************************************************************/
+#ifndef OCTAFLIP_BOOK_H
+#define OCTAFLIP_BOOK_H
+
+#include <stdint.h>
+#include "engine.h"
+
+#define BOOK_MAGIC   0x4B42464FU        /* "OFBK" */
+#define BOOK_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                      /* 보드 한 변 (OCTAFLIP_SIZE 와 같아야 함) */
+    uint32_t entry_size;                /* sizeof(BookEntry) */
+    uint64_t count;
+} BookHeader;
+
+typedef struct {
+    uint64_t key;                       /* canon_key(정규형) */
+    uint16_t move;                      /* from | to << 8, 정규형 방향 */
+    int16_t  score;                     /* 둘 차례 관점 */
+    uint8_t  depth;                     /* 탐색한 깊이 */
+    uint8_t  pad[3];
+} BookEntry;
+
+typedef struct Book Book;
+
+/* 파일을 mmap 한다.  실패하면 이유를 출력하고 NULL */
+Book *book_open(const char *path);
+void  book_close(Book *book);
+uint64_t book_count(const Book *book);
+
+/* side 차례 p 를 찾아 원래 방향의 수를 돌려준다.  없으면 0 */
+int book_probe(const Book *book, const Pos *p, int side,
+               int *from, int *to, int *score, int *depth);
+
+/* 항목을 key 순으로 정렬해 파일로 (book_build 용).  실패하면 -1 */
+int book_write(const char *path, BookEntry *entries, uint64_t count);
+
+#endif /* OCTAFLIP_BOOK_H */
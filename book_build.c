@@ -0,0 +1,273 @@
+/********************************************************************
+ *  book_build.c ― opening book 만들기 (book.h)
+ *
+ *  1) 시작 국면에서 -plies N 수 안에 둘 차례가 오는 국면을 모두 모은다.
+ *     정규형(pos_canonical)으로 중복을 없애므로 대칭·색을 바꾼 국면은
+ *     한 번만 센다.
+ *  2) 스레드마다 엔진을 하나씩 두고 국면을 나눠 고정 깊이(-depth) 또는
+ *     고정 시간(-time)으로 탐색해 최선 수·점수를 남긴다.
+ *  3) key 순으로 정렬해 book 파일로 쓴다.  client2 -book <file> 로 쓴다.
+ *
+ *  시작 국면은 네 귀퉁이 (server.c 와 같음), -pos 로 막힌 칸이 있는
+ *  국면 등을 줄 수 있다.  서버가 무작위로 몇 수 두고 시작한다면
+ *  (-open-plies) 그만큼 -plies 를 늘려야 book 에 걸린다.
+ *
+ *  빌드:
+ *      gcc book_build.c engine.c nnue.c book.c cache.c -o book_build -O2 -Wall -Wextra -lm -pthread
+ *
+ *  실행 예:
+ *      ./book_build -plies 4 -depth 12 -threads 8 -o octaflip.book
+ *      ./book_build -plies 3 -time 10 -pos R......B/......../......../...#..../....#.../......../......../B......R R -o blocked.book
+ *******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "engine.h"
+#include "book.h"
+
+#define SCORE_CLAMP 30000       /* int16 에 들도록 (승패 점수 ±INF/2 포함) */
+
+/* ───── 국면 모으기 ─────────────────────────────────────────────── */
+/* 정규형 국면 집합: canon_key 로 여는 open addressing */
+typedef struct {
+    Pos      *pos;              /* 넣은 순서 (= 수 순) */
+    uint64_t *keys;             /* 해시 칸, 0 = 빈칸 */
+    size_t    count, cap;       /* cap 은 2의 거듭제곱, count ≤ cap / 2 */
+} PosSet;
+
+static int set_grow(PosSet *s)
+{
+    size_t ncap = s->cap ? s->cap * 2 : 1024;
+    uint64_t *keys = calloc(ncap, sizeof(uint64_t));
+    Pos *pos = realloc(s->pos, ncap / 2 * sizeof(Pos));
+    if (!keys || !pos) {
+        free(keys);
+        return -1;
+    }
+    for (size_t i = 0; i < s->count; ++i) {
+        uint64_t k = canon_key(&pos[i]) | 1;
+        size_t h = k & (ncap - 1);
+        while (keys[h]) h = (h + 1) & (ncap - 1);
+        keys[h] = k;
+    }
+    free(s->keys);
+    s->keys = keys;
+    s->pos  = pos;
+    s->cap  = ncap;
+    return 0;
+}
+
+/* 없던 국면이면 넣고 1 */
+static int set_add(PosSet *s, const Pos *canon)
+{
+    if ((s->count + 1) * 2 > s->cap && set_grow(s) < 0) {
+        fprintf(stderr, "[Book] out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    uint64_t k = canon_key(canon) | 1;       // 0 은 빈칸 표시
+    size_t h = k & (s->cap - 1);
+    for (; s->keys[h]; h = (h + 1) & (s->cap - 1))
+        if (s->keys[h] == k) return 0;
+    s->keys[h] = k;
+    s->pos[s->count++] = *canon;
+    return 1;
+}
+
+/* 정규형 국면(둘 차례 = RED) 의 다음 국면들을 정규형으로 set 에 */
+static void expand(PosSet *set, const Pos *p)
+{
+    if (!p->bb[RED] || !p->bb[BLUE]) return;        // 전멸: 게임 끝
+    Move mv[MAX_MOVES];
+    Pos q, canon;
+    int n = gen_moves(p, RED, mv);
+    if (n == 0) {
+        if (!has_moves(p, BLUE)) return;            // 게임 끝
+        pos_canonical(p, BLUE, &canon);             // 패스
+        set_add(set, &canon);
+        return;
+    }
+    for (int i = 0; i < n; ++i) {
+        Undo u;
+        q = *p;
+        make_move(&q, RED, mv[i].from, mv[i].to, &u);
+        pos_canonical(&q, BLUE, &canon);
+        set_add(set, &canon);
+    }
+}
+
+/* ───── 탐색 ────────────────────────────────────────────────────── */
+typedef struct {
+    pthread_t    tid;
+    Engine      *engine;
+    const Pos   *pos;
+    BookEntry   *out;
+    size_t       count;
+    atomic_size_t *next;        /* 다음에 가져갈 국면 (모든 스레드 공용) */
+    double       secs;          /* 0 이면 고정 깊이 */
+    time_t       t0;
+} BuildJob;
+
+static void pos_to_board(const Pos *p, char bd[SIZE][SIZE])
+{
+    for (int sq = 0; sq < NSQ; ++sq)
+        bd[sq / SIZE][sq % SIZE] = (p->bb[RED]  & BB_SQ(sq)) ? 'R'
+                                 : (p->bb[BLUE] & BB_SQ(sq)) ? 'B'
+                                 : (p->blocked  & BB_SQ(sq)) ? '#' : '.';
+}
+
+static void *build_worker(void *arg)
+{
+    BuildJob *job = arg;
+    for (;;) {
+        size_t i = atomic_fetch_add(job->next, 1);
+        if (i >= job->count) break;
+        char bd[SIZE][SIZE];
+        EngineResult res;
+        pos_to_board(&job->pos[i], bd);
+        engine_search(job->engine, bd, 'R', job->secs > 0 ? job->secs : INFINITY, &res);
+
+        BookEntry *e = &job->out[i];
+        memset(e, 0, sizeof(*e));
+        e->key = canon_key(&job->pos[i]);
+        if (res.move.r1 < 0) {
+            e->move = 0xFFFF;           // 패스 (쓸 때 뺀다)
+            continue;
+        }
+        int s = res.score;
+        if (s >  SCORE_CLAMP) s =  SCORE_CLAMP;
+        if (s < -SCORE_CLAMP) s = -SCORE_CLAMP;
+        e->move  = (uint16_t)((res.move.r1 * SIZE + res.move.c1)
+                            | (res.move.r2 * SIZE + res.move.c2) << 8);
+        e->score = (int16_t)s;
+        e->depth = (uint8_t)(res.solved ? MAX_PLY - 1 : res.depth);
+        if ((i + 1) % 100 == 0)
+            fprintf(stderr, "[Book] %zu / %zu positions, %lds\n",
+                    i + 1, job->count, (long)(time(NULL) - job->t0));
+    }
+    return NULL;
+}
+
+/* =================================================================
+*                              main
+* =================================================================*/
+static void build_usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s -o <book> [-plies <N>] [-depth <D> | -time <sec>]"
+            " [-threads <T>] [-hash <MB>] [-pos <board> R|B]\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    int plies = 4, depth = 10, threads = 1;
+    double secs = 0;
+    const char *out = NULL;
+    char bd[SIZE][SIZE];
+    char me = 'R';
+    EngineConfig cfg = ENGINE_CONFIG_DEFAULT;
+    cfg.hash_mb = 64;
+
+    memset(bd, '.', sizeof(bd));
+    bd[0][0] = bd[SIZE - 1][SIZE - 1] = 'R';
+    bd[0][SIZE - 1] = bd[SIZE - 1][0] = 'B';
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-plies") == 0) {
+            plies = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-depth") == 0) {
+            depth = atoi(argv[++i]);
+            secs = 0;
+        } else if (i + 1 < argc && strcmp(argv[i], "-time") == 0) {
+            secs = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-threads") == 0) {
+            threads = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-hash") == 0) {
+            cfg.hash_mb = strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+            out = argv[++i];
+        } else if (i + 2 < argc && strcmp(argv[i], "-pos") == 0) {
+            const char *s = argv[++i];
+            int cells = 0;
+            for (; *s; ++s) {
+                if (*s == '/') continue;
+                if (cells < NSQ) bd[cells / SIZE][cells % SIZE] = *s;
+                ++cells;
+            }
+            me = argv[++i][0];
+            if (cells != NSQ || (me != 'R' && me != 'B')) build_usage(argv[0]);
+        } else {
+            build_usage(argv[0]);
+        }
+    }
+    if (!out || plies < 1 || depth < 1 || depth >= MAX_PLY
+        || threads < 1 || threads > MAX_THREADS || cfg.hash_mb == 0)
+        build_usage(argv[0]);
+    init_bitboards();
+
+    // (1) 수 순으로 한 층씩: set 의 [begin, end) 가 한 층
+    PosSet set = { 0 };
+    Pos root, canon;
+    board_to_pos(bd, &root);
+    pos_canonical(&root, color_index(me), &canon);
+    set_add(&set, &canon);
+    size_t begin = 0, end = set.count;
+    for (int ply = 1; ply < plies; ++ply) {
+        for (size_t i = begin; i < end; ++i) {
+            Pos p = set.pos[i];             // set_add 가 pos 를 옮길 수 있다
+            expand(&set, &p);
+        }
+        fprintf(stderr, "[Book] ply %d: %zu positions\n", ply, set.count - end);
+        begin = end;
+        end = set.count;
+    }
+    fprintf(stderr, "[Book] %zu positions within %d plies\n", set.count, plies);
+
+    // (2) 탐색
+    cfg.threads = 1;
+    cfg.max_depth = depth;
+    BookEntry *entries = malloc(set.count * sizeof(BookEntry));
+    BuildJob *jobs = calloc(threads, sizeof(BuildJob));
+    atomic_size_t next = 0;
+    if (!entries || !jobs) {
+        fprintf(stderr, "[Book] out of memory\n");
+        return EXIT_FAILURE;
+    }
+    time_t t0 = time(NULL);
+    for (int t = 0; t < threads; ++t) {
+        jobs[t] = (BuildJob){ .engine = engine_create(&cfg), .pos = set.pos,
+                              .out = entries, .count = set.count, .next = &next,
+                              .secs = secs, .t0 = t0 };
+        if (!jobs[t].engine
+            || (t > 0 && pthread_create(&jobs[t].tid, NULL, build_worker, &jobs[t]) != 0)) {
+            fprintf(stderr, "[Book] engine init failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+    build_worker(&jobs[0]);
+    for (int t = 1; t < threads; ++t) pthread_join(jobs[t].tid, NULL);
+    for (int t = 0; t < threads; ++t) engine_destroy(jobs[t].engine);
+
+    // (3) 패스 국면은 빼고 쓴다
+    size_t n = 0;
+    for (size_t i = 0; i < set.count; ++i)
+        if (entries[i].move != 0xFFFF) entries[n++] = entries[i];
+    if (book_write(out, entries, n) < 0) {
+        perror("[Book] write");
+        return EXIT_FAILURE;
+    }
+    printf("saved %s: %zu positions, %s %g, %lds\n", out, n,
+           secs > 0 ? "time" : "depth", secs > 0 ? secs : depth, (long)(time(NULL) - t0));
+    free(entries);
+    free(jobs);
+    free(set.pos);
+    free(set.keys);
+    return 0;
+}
@@ -0,0 +1,177 @@
+/********************************************************************
+ *  cache.c ― 디스크 국면 캐시: 파일 만들기·mmap, 찾기, 쓰기
+ *
+ *  빌드 (engine.c 와 함께):
+ *      gcc -c cache.c -O2 -Wall -Wextra [-DOCTAFLIP_SIZE=N]
+ *******************************************************************/
+
+#define _DEFAULT_SOURCE             /* flock */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cache.h"
+
+struct Cache {
+    void        *map;
+    size_t       len;
+    CacheBucket *buckets;
+    uint64_t     mask;
+};
+
+/* ───── 열기·닫기 ────────────────────────────────────────────────── */
+Cache *cache_open(const char *path, size_t mb, uint64_t tag)
+{
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        perror("[Cache] open");
+        return NULL;
+    }
+    // 여러 프로세스가 동시에 처음 열 수 있으므로 만들기·검사 동안만 잠근다
+    if (flock(fd, LOCK_EX) < 0) {
+        perror("[Cache] flock");
+        close(fd);
+        return NULL;
+    }
+    const char *why = NULL;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        why = "stat failed";
+    } else if (st.st_size == 0) {
+        uint64_t n = 1;
+        while (n * 2 * sizeof(CacheBucket) <= (mb << 20)) n *= 2;
+        CacheHeader h = { CACHE_MAGIC, CACHE_VERSION, SIZE, CACHE_WAYS, n, tag, { 0 } };
+        st.st_size = sizeof(h) + n * sizeof(CacheBucket);
+        if (ftruncate(fd, st.st_size) < 0 || pwrite(fd, &h, sizeof(h), 0) != sizeof(h))
+            why = "could not create";
+    }
+    void *map = MAP_FAILED;
+    if (!why) {
+        map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) why = "mmap failed";
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+
+    if (!why) {
+        const CacheHeader *h = map;
+        if ((size_t)st.st_size < sizeof(CacheHeader) || h->magic != CACHE_MAGIC)
+            why = "not a cache file";
+        else if (h->version != CACHE_VERSION || h->size != SIZE || h->ways != CACHE_WAYS)
+            why = "built for another version or board size";
+        else if (h->tag != tag)
+            why = "written with another evaluator or settings";
+        else if (h->buckets == 0 || (h->buckets & (h->buckets - 1))
+                 || h->buckets > (st.st_size - sizeof(CacheHeader)) / sizeof(CacheBucket))
+            why = "truncated";
+    }
+    Cache *cache = why ? NULL : malloc(sizeof(Cache));
+    if (!cache) {
+        fprintf(stderr, "[Cache] %s: %s\n", path, why ? why : "out of memory");
+        if (map != MAP_FAILED) munmap(map, st.st_size);
+        return NULL;
+    }
+    cache->map     = map;
+    cache->len     = st.st_size;
+    cache->buckets = (CacheBucket *)((CacheHeader *)map + 1);
+    cache->mask    = ((const CacheHeader *)map)->buckets - 1;
+    return cache;
+}
+
+void cache_close(Cache *cache)
+{
+    if (!cache) return;
+    munmap(cache->map, cache->len);     // 내용은 커널이 파일로 내린다
+    free(cache);
+}
+
+/* ───── 찾기·쓰기 ────────────────────────────────────────────────── */
+#define CACHE_WIN_BIT (1ULL << 40)
+
+static inline uint64_t cache_pack(int move, int score, int depth)
+{
+    // 승패 점수는 win 비트 + 부호, 나머지는 int16 에 맞춰 자른다
+    uint64_t win = 0;
+    if (score >= SCORE_WIN / 2 || score <= -SCORE_WIN / 2) {
+        win = CACHE_WIN_BIT;
+        score = score > 0 ? 1 : -1;
+    }
+    if (score >  INT16_MAX) score =  INT16_MAX;
+    if (score < -INT16_MAX) score = -INT16_MAX;
+    return (uint64_t)(uint16_t)move | (uint64_t)(uint16_t)(int16_t)score << 16
+         | (uint64_t)(uint8_t)depth << 32 | win;
+}
+
+static inline int cache_score(uint64_t data)
+{
+    int score = (int16_t)(data >> 16);
+    if (data & CACHE_WIN_BIT) score = score > 0 ? SCORE_WIN : -SCORE_WIN;
+    return score;
+}
+
+/* max_depth 가 다르면 다른 key (같은 묶음에 나란히 남을 수도 있다) */
+static inline uint64_t cache_key(const Pos *canon, int max_depth)
+{
+    return canon_key(canon) ^ (uint64_t)max_depth * 0x9E3779B97F4A7C15ULL;
+}
+
+int cache_probe(const Cache *cache, const Pos *p, int side, int max_depth,
+                int *from, int *to, int *score, int *depth)
+{
+    Pos canon;
+    int sym = pos_canonical(p, side, &canon);
+    uint64_t key = cache_key(&canon, max_depth);
+    CacheBucket *b = &cache->buckets[key & cache->mask];
+    for (int i = 0; i < CACHE_WAYS; ++i) {
+        uint64_t data  = atomic_load_explicit(&b->e[i].data,  memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&b->e[i].check, memory_order_relaxed);
+        if ((check ^ data) != key || data == 0) continue;
+        int f = data & 0xFF, t = (data >> 8) & 0xFF;
+        if (f >= NSQ || t >= NSQ) return 0;
+        f = sq_transform(f, sym_inverse(sym));
+        t = sq_transform(t, sym_inverse(sym));
+        // 64비트 key 가 우연히 겹친 경우: 수가 이 국면에서 말이 되지 않는다
+        if (!(p->bb[side] & BB_SQ(f)) || !((ADJ[f] | JUMP[f]) & empty_bb(p) & BB_SQ(t)))
+            return 0;
+        *from  = f;
+        *to    = t;
+        *score = cache_score(data);
+        *depth = (data >> 32) & 0xFF;
+        return 1;
+    }
+    return 0;
+}
+
+void cache_store(Cache *cache, const Pos *p, int side, int max_depth,
+                 int from, int to, int score, int depth)
+{
+    Pos canon;
+    int sym = pos_canonical(p, side, &canon);
+    uint64_t key = cache_key(&canon, max_depth);
+    CacheBucket *b = &cache->buckets[key & cache->mask];
+    if (depth > 255) depth = 255;
+
+    // 같은 국면이면 그 칸, 아니면 가장 얕은 칸 (빈칸은 depth 0)
+    CacheEntry *victim = &b->e[0];
+    int victim_depth = 256;
+    for (int i = 0; i < CACHE_WAYS; ++i) {
+        uint64_t data  = atomic_load_explicit(&b->e[i].data,  memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&b->e[i].check, memory_order_relaxed);
+        int d = data ? (int)((data >> 32) & 0xFF) : 0;
+        if ((check ^ data) == key && data) {
+            if (d > depth) return;
+            victim = &b->e[i];
+            break;
+        }
+        if (d < victim_depth) { victim_depth = d; victim = &b->e[i]; }
+    }
+    int move = sq_transform(from, sym) | sq_transform(to, sym) << 8;
+    uint64_t data = cache_pack(move, score, depth);
+    atomic_store_explicit(&victim->check, key ^ data, memory_order_relaxed);
+    atomic_store_explicit(&victim->data,  data,       memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+/********************************************************************
+ *  cache.h ― 프로세스·대국을 넘어 남는 디스크 국면 캐시
+ *
+ *  루트 탐색 결과 (key, 깊이, 점수, 최선 수) 를 파일에 두고 한 호스트의
+ *  클라이언트들이 MAP_SHARED 로 함께 쓴다.  engine_search 는 루트를 먼저
+ *  찾아 최선 수를 루트 첫 후보로 두고, 끝낸 깊이가 캐시보다 얕으면
+ *  캐시 쪽 결과를 쓰며, 더 깊으면 자기 결과를 써 넣는다.
+ *
+ *  - 크기 고정: 처음 만들 때 cache_mb 로 정하고 늘지 않는다.  칸이 차면
+ *    치환표처럼 같은 묶음(bucket) 안에서 가장 얕은 항목을 바꾼다.
+ *  - lock 없음: 항목은 64비트 두 개 (check = key ^ data, data) 라
+ *    읽는 쪽은 둘을 XOR 해 key 가 맞을 때만 믿는다.  쓰기가 겹쳐 반쯤
+ *    쓰인 항목은 key 가 맞지 않아 그냥 없는 것으로 보인다.
+ *  - 국면은 pos_canonical 정규형 (canon_key) 으로 찾으므로 대칭·색을
+ *    바꾼 국면이 항목을 나눠 쓴다.  수는 정규형 방향으로 저장한다.
+ *  - 점수는 평가 함수마다 뜻이 달라 header 의 tag (평가 함수·가중치
+ *    식별값) 가 다른 파일은 열지 않는다.  max_depth 가 다른 탐색의
+ *    결과는 key 를 달리해 서로 다른 항목이 된다.
+ *  - 승패가 난 점수 (±SCORE_WIN) 는 int16 에 들지 않으므로 win 비트와
+ *    부호로 두고, 찾을 때 ±SCORE_WIN 으로 되돌린다.
+ *
+ *  파일: CacheHeader (64 바이트) + CacheBucket[bucket 수] (64 바이트씩)
+ *******************************************************************/
+#ifndef OCTAFLIP_CACHE_H
+#define OCTAFLIP_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "engine.h"
+
+#define CACHE_MAGIC   0x4350464FU       /* "OFPC" */
+#define CACHE_VERSION 2
+#define CACHE_WAYS    4
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                      /* 보드 한 변 (OCTAFLIP_SIZE 와 같아야 함) */
+    uint32_t ways;                      /* CACHE_WAYS */
+    uint64_t buckets;                   /* 2의 거듭제곱 */
+    uint64_t tag;                       /* 만든 엔진의 평가 함수·설정 (cache_open 인자) */
+    uint8_t  pad[32];
+} CacheHeader;
+
+/* data: move 16 | score(int16) 16 | depth 8 | win 1 (score 는 부호만)  */
+typedef struct {
+    _Atomic uint64_t check;             /* canon_key ^ data */
+    _Atomic uint64_t data;
+} CacheEntry;
+
+typedef struct {
+    CacheEntry e[CACHE_WAYS];
+} CacheBucket;
+
+typedef struct Cache Cache;
+
+/* 파일을 열어 mmap (없거나 비었으면 mb 크기로 만든다).  파일의 tag 가 다르거나
+   실패하면 이유를 출력하고 NULL */
+Cache *cache_open(const char *path, size_t mb, uint64_t tag);
+void   cache_close(Cache *cache);
+
+/* max_depth 로 탐색한 side 차례 p 의 항목을 원래 방향의 수로.  없으면 0 */
+int  cache_probe(const Cache *cache, const Pos *p, int side, int max_depth,
+                 int *from, int *to, int *score, int *depth);
+/* 같은 국면이 이미 더 깊게 있으면 그대로 둔다 */
+void cache_store(Cache *cache, const Pos *p, int side, int max_depth,
+                 int from, int to, int score, int depth);
+
+#endif /* OCTAFLIP_CACHE_H */
@@ -2,39 +2,69 @@
 /********************************************************************
  *  client2_strong.c ― Iterative Deepening + α‐β (강화 AI)
  *
- *  빌드:
- *      gcc client_strong.c cJSON.c -o client_strong -O2 -lm
+ *  빌드 (탐색은 engine.c, 보드 크기는 -DOCTAFLIP_SIZE=N 로 6 ~ 10):
+ *      gcc client2.c engine.c nnue.c book.c cache.c cJSON.c -o client2 -O2 -Wall -Wextra -lm -pthread
+ *    탐색 통계(-stats <file>, JSON lines)까지:
+ *      gcc -DOCTAFLIP_STATS client2.c engine.c nnue.c book.c cache.c cJSON.c -o client2 -O2 -Wall -Wextra -lm -pthread
+ *    신경망 평가(-eval <weights>)를 AVX2 로 돌리려면 -march=native 를 더한다.
+ *    -mcts 1 이면 α-β 대신 MCTS 로 둔다 (-hash 는 노드 arena 크기).
+ *    -book <file> 이면 book_build 가 만든 opening book 국면은 바로 둔다.
+ *    -cache <file> 이면 루트 탐색 결과를 디스크 캐시에 남겨 다음 대국·다른
+ *    클라이언트 프로세스가 이어 쓴다 (-cache-mb 는 파일을 새로 만들 때 크기).
+ *    cJSON 할당은 메시지마다 비우는 정적 arena 로 가고, 게임이 끝나면
+ *    "json ... heap allocs" 줄로 malloc 으로 샌 횟수를 알린다.
+ *
+ *  -games N: 한 프로세스가 서버 연결 N 개로 N 판을 동시에 둔다 (epoll).
+ *  탐색은 엔진을 하나씩 가진 worker M 개 (-workers, 기본 코어 수) 가
+ *  나눠 맡고 -hash, -threads 는 worker 하나의 값이다.
  *
  *  실행 예:
- *      ./client_strong -ip 127.0.0.1 -port 12345 -username Bob
+ *      ./client_strong -ip 127.0.0.1 -port 12345 -username Bob [-threads 8]
+ *      ./client_strong -ip 127.0.0.1 -port 12345 -username Bot -games 200 -workers 8
  *******************************************************************/
 
 #define _POSIX_C_SOURCE 200809L
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <unistd.h>         
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
-#include <time.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include "cJSON.h"
-#include <math.h>
+#include "engine.h"
+#include "nnue.h"
 
-#define SIZE     8
 #define BUF_SIZE 1024
-#define INF      1000000000
 
 /* ───── 인자 파싱 ─────────────────────────────────────────────────── */
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s -ip <server_ip> -port <port> -username <name>"
+            " [-hash <MB>] [-threads <N>] [-ponder 0|1]"
+            " [-endgame <empties>] [-stats <file>] [-eval <weights>] [-book <file>] [-mcts 0|1]"
+            " [-cache <file> [-cache-mb <MB>]] [-games <N> [-workers <M>]]\n",
+            prog);
+    exit(EXIT_FAILURE);
+}
+
 static void parse_args(int argc, char *argv[],
-                    char *ip, int *port, char *username)
+                    char *ip, int *port, char *username,
+                    size_t *hash_mb, int *threads, int *ponder,
+                    int *endgame, const char **stats_log, const char **eval_file,
+                    const char **book_file, const char **cache_file, size_t *cache_mb,
+                    int *mcts, int *games, int *workers)
 {
-    if (argc != 7) {
-        fprintf(stderr,
-                "Usage: %s -ip <server_ip> -port <port> -username <name>\n",
-                argv[0]);
-        exit(EXIT_FAILURE);
-    }
+    if (argc < 7 || argc % 2 == 0) usage(argv[0]);
     for (int i = 1; i < argc; i += 2) {
         if (strcmp(argv[i], "-ip") == 0) {
             strncpy(ip, argv[i+1], INET_ADDRSTRLEN - 1);
@@ -48,54 +78,309 @@ static void parse_args(int argc, char *argv[],
         } else if (strcmp(argv[i], "-username") == 0) {
             strncpy(username, argv[i+1], 31);
             username[31] = '\0';
+            if (strpbrk(username, "\"\\")) {    // move 응답에 그대로 들어간다
+                fprintf(stderr, "[Client] Invalid username: %s\n", argv[i+1]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "-hash") == 0) {
+            *hash_mb = strtoul(argv[i+1], NULL, 10);
+            if (*hash_mb == 0) {
+                fprintf(stderr, "[Client] Invalid hash size: %s\n", argv[i+1]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "-threads") == 0) {
+            *threads = atoi(argv[i+1]);
+            if (*threads < 1 || *threads > MAX_THREADS) {
+                fprintf(stderr, "[Client] Invalid thread count: %s\n", argv[i+1]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "-ponder") == 0) {
+            *ponder = atoi(argv[i+1]) != 0;
+        } else if (strcmp(argv[i], "-endgame") == 0) {
+            *endgame = atoi(argv[i+1]);
+        } else if (strcmp(argv[i], "-stats") == 0) {
+            *stats_log = argv[i+1];     // engine.c 를 -DOCTAFLIP_STATS 로 빌드했을 때만
+        } else if (strcmp(argv[i], "-eval") == 0) {
+            *eval_file = argv[i+1];     // nn_train 이 만든 가중치
+        } else if (strcmp(argv[i], "-book") == 0) {
+            *book_file = argv[i+1];     // book_build 가 만든 opening book
+        } else if (strcmp(argv[i], "-cache") == 0) {
+            *cache_file = argv[i+1];    // 없으면 새로 만든다
+        } else if (strcmp(argv[i], "-cache-mb") == 0) {
+            *cache_mb = strtoul(argv[i+1], NULL, 10);
+            if (*cache_mb == 0) {
+                fprintf(stderr, "[Client] Invalid cache size: %s\n", argv[i+1]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "-mcts") == 0) {
+            *mcts = atoi(argv[i+1]) != 0;
+        } else if (strcmp(argv[i], "-games") == 0) {
+            *games = atoi(argv[i+1]);
+            if (*games < 1) {
+                fprintf(stderr, "[Client] Invalid game count: %s\n", argv[i+1]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "-workers") == 0) {
+            *workers = atoi(argv[i+1]);
+            if (*workers < 1) {
+                fprintf(stderr, "[Client] Invalid worker count: %s\n", argv[i+1]);
+                exit(EXIT_FAILURE);
+            }
         } else {
             fprintf(stderr, "[Client] Unknown option: %s\n", argv[i]);
             exit(EXIT_FAILURE);
         }
     }
+    if (!ip[0] || !*port || !username[0]) usage(argv[0]);
+}
+
+/* ───── 줄 단위 수신 ─────────────────────────────────────────────── */
+/* 연결마다 하나.  버퍼는 한 번 잡아 두고 더 긴 줄이 올 때만 두 배로 늘린다 */
+typedef struct {
+    char  *buf;
+    size_t cap, used, consumed;
+} LineBuf;
+
+/* 이미 받아 둔 것 중 개행을 뺀 한 줄(NUL 종료).  다음 호출 전까지만 유효, 없으면 NULL */
+static char *line_next(LineBuf *lb, size_t *out_len)
+{
+    for (;;) {
+        // 지난번에 돌려준 줄은 이제 버린다
+        if (lb->consumed) {
+            memmove(lb->buf, lb->buf + lb->consumed, lb->used - lb->consumed);
+            lb->used -= lb->consumed;
+            lb->consumed = 0;
+        }
+        char *nl = lb->buf ? memchr(lb->buf, '\n', lb->used) : NULL;
+        if (!nl) return NULL;
+        size_t len = nl - lb->buf;
+        lb->consumed = len + 1;
+        if (len > 0 && lb->buf[len - 1] == '\r') --len;
+        if (len == 0) continue;
+        lb->buf[len] = '\0';
+        *out_len = len;
+        return lb->buf;
+    }
 }
 
-/* ───── robust recv_json ─────────────────────────────────────────── */
-static cJSON* recv_json(int sockfd)
+/* recv 한 번으로 버퍼를 채운다.  recv 의 반환값 (0 = 끊김, 버퍼 실패도 -1) */
+static ssize_t line_fill(LineBuf *lb, int sockfd, int flags)
 {
-    _Thread_local static char   buf[BUF_SIZE];
-    _Thread_local static size_t used = 0;
+    if (lb->used + 1 >= lb->cap) {
+        size_t ncap = lb->cap ? lb->cap * 2 : BUF_SIZE;
+        char *nbuf = realloc(lb->buf, ncap);
+        if (!nbuf) {
+            fprintf(stderr, "[Client] recv buffer realloc failed\n");
+            return -1;
+        }
+        lb->buf = nbuf;
+        lb->cap = ncap;
+    }
+    ssize_t n = recv(sockfd, lb->buf + lb->used, lb->cap - lb->used - 1, flags);
+    if (n > 0) lb->used += n;
+    return n;
+}
 
+/* 한 줄이 올 때까지 기다린다.  끊기면 NULL */
+static char *recv_line(LineBuf *lb, int sockfd, size_t *out_len)
+{
     for (;;) {
-        char *nl = memchr(buf, '\n', used);
-        if (nl) {
-            size_t linelen = nl - buf;
-            if (linelen == 0) {
-                size_t remain = used - 1;
-                memmove(buf, nl + 1, remain);
-                used = remain;
-                continue;
-            }
-            char json_txt[BUF_SIZE];
-            memcpy(json_txt, buf, linelen);
-            json_txt[linelen] = '\0';
+        char *line = line_next(lb, out_len);
+        if (line) return line;
+        if (line_fill(lb, sockfd, 0) <= 0) return NULL;
+    }
+}
+
+/* ───── cJSON arena ─────────────────────────────────────────────── */
+/* cJSON 의 할당을 메시지 하나 동안만 쓰는 bump arena 로 돌린다.  free 는
+   아무것도 하지 않고, 메시지를 다 쓰고 json_delete 가 통째로 비운다.
+   arena 는 정적 버퍼라 malloc 이 없고, 넘치는 큰 메시지만 malloc 으로 가서
+   heap_allocs 에 잡힌다.  cJSON 은 메인(loop) 스레드만 쓴다. */
+#define JSON_ARENA_SIZE (64 * 1024)
+
+static _Alignas(16) char json_arena_buf[JSON_ARENA_SIZE];
+static struct {
+    size_t        used, peak;   /* 지금 메시지가 쓴 바이트, 가장 많이 쓴 메시지 */
+    unsigned long messages;     /* 비운 횟수 (= 처리한 메시지) */
+    unsigned long allocs;       /* arena 에서 내준 횟수 */
+    unsigned long heap_allocs;  /* arena 가 모자라 malloc 한 횟수 */
+} json_arena;
+
+static void *json_malloc(size_t sz)
+{
+    size_t need = (sz + 15) & ~(size_t)15;
+    if (need <= JSON_ARENA_SIZE - json_arena.used) {
+        void *p = json_arena_buf + json_arena.used;
+        json_arena.used += need;
+        ++json_arena.allocs;
+        return p;
+    }
+    ++json_arena.heap_allocs;
+    return malloc(sz);
+}
+
+static void json_free(void *p)
+{
+    if ((char *)p >= json_arena_buf && (char *)p < json_arena_buf + JSON_ARENA_SIZE)
+        return;                 // arena 몫은 json_delete 에서 한꺼번에
+    free(p);
+}
 
-            size_t remain = used - (linelen + 1);
-            memmove(buf, nl + 1, remain);
-            used = remain;
+static void json_init(void)
+{
+    cJSON_Hooks hooks = { json_malloc, json_free };
+    cJSON_InitHooks(&hooks);
+}
 
-            cJSON *json = cJSON_Parse(json_txt);
-            if (json) return json;
+/* 메시지 하나를 다 썼다: 트리를 지우고 arena 를 비운다 (살아 있는 트리가 없어야 함) */
+static void json_delete(cJSON *msg)
+{
+    cJSON_Delete(msg);
+    if (json_arena.used > json_arena.peak) json_arena.peak = json_arena.used;
+    json_arena.used = 0;
+    ++json_arena.messages;
+}
 
-            fprintf(stderr, "[Client] cJSON_Parse error, ignored: %s\n", json_txt);
-            continue;
+/* 게임이 끝날 때 한 줄: heap 이 0 이면 메시지 처리에 malloc 이 없었다 */
+static void json_report(const char *who)
+{
+    printf("[Client %s] json %lu msgs, %lu arena allocs (peak %zu bytes), %lu heap allocs\n",
+           who, json_arena.messages, json_arena.allocs, json_arena.peak,
+           json_arena.heap_allocs);
+}
+
+/* ───── robust recv_json (your_turn 외 메시지용) ─────────────────── */
+static cJSON* recv_json(LineBuf *lb, int sockfd)
+{
+    for (;;) {
+        size_t len;
+        char *line = recv_line(lb, sockfd, &len);
+        if (!line) return NULL;
+        cJSON *json = cJSON_ParseWithLength(line, len);
+        if (json) return json;
+        json_delete(NULL);
+        fprintf(stderr, "[Client] cJSON_Parse error, ignored: %s\n", line);
+    }
+}
+
+/* ───── your_turn 빠른 경로 ─────────────────────────────────────── */
+/* 최상위 객체의 "key" : 뒤의 값 시작 위치.  키 자리({ 나 , 바로 뒤,
+   깊이 1)의 문자열만 보고 문자열 값·중첩 객체·배열 안은 건너뛰므로
+   사용자 이름 같은 값에 든 "board": 에 속지 않는다.  키 순서·공백에는
+   상관없고, 없거나 모양이 이상하면 NULL (cJSON 경로로) */
+static const char *json_value(const char *s, const char *key)
+{
+    size_t klen = strlen(key);
+    int depth = 0, at_key = 0;
+    for (const char *p = s; *p; ++p) {
+        switch (*p) {
+        case '"': {
+            const char *str = ++p;
+            for (; *p && *p != '"'; ++p)
+                if (*p == '\\' && p[1]) ++p;
+            if (!*p) return NULL;
+            if (!at_key) break;
+            at_key = 0;
+            if ((size_t)(p - str) != klen || strncmp(str, key, klen) != 0) break;
+            const char *v = p + 1;
+            while (*v == ' ' || *v == '\t') ++v;
+            if (*v != ':') return NULL;
+            ++v;
+            while (*v == ' ' || *v == '\t') ++v;
+            return v;
+        }
+        case '{': case '[':
+            at_key = (*p == '{' && depth == 0);
+            ++depth;
+            break;
+        case '}': case ']':
+            --depth;
+            break;
+        case ',':
+            at_key = (depth == 1);
+            break;
         }
+    }
+    return NULL;
+}
 
-        ssize_t n = recv(sockfd, buf + used, BUF_SIZE - used - 1, 0);
-        if (n <= 0) return NULL;
-        used += n;
-        buf[used] = '\0';
+/* your_turn 이면 보드·timeout 을 바로 채우고 1.  힙 할당 없음.
+   다른 메시지이거나 예상과 다른 모양이면 0 (cJSON 경로로 넘긴다) */
+static int parse_your_turn(const char *line, char bd[SIZE][SIZE], double *timeout)
+{
+    const char *v = json_value(line, "type");
+    if (!v || strncmp(v, "\"your_turn\"", 11) != 0) return 0;
 
-        if (used >= BUF_SIZE - 1) {
-            fprintf(stderr, "[recv_json] buffer overflow\n");
-            return NULL;
+    v = json_value(line, "board");
+    if (!v || *v != '[') return 0;
+    ++v;
+    for (int r = 0; r < SIZE; ++r) {
+        while (*v == ' ' || *v == '\t' || (r > 0 && *v == ',')) ++v;
+        if (*v != '"') return 0;
+        for (int c = 0; c < SIZE; ++c)
+            if (v[1 + c] == '"' || v[1 + c] == '\\' || v[1 + c] == '\0') return 0;
+        if (v[1 + SIZE] != '"') return 0;
+        memcpy(bd[r], v + 1, SIZE);
+        v += SIZE + 2;
+    }
+    while (*v == ' ' || *v == '\t') ++v;
+    if (*v != ']') return 0;
+
+    v = json_value(line, "timeout");
+    if (!v) return 0;
+    char *end;
+    *timeout = strtod(v, &end);
+    return end != v;
+}
+
+/* 빠른 경로가 못 읽은 your_turn (cJSON).  모양이 틀리면 0 */
+static int json_your_turn(cJSON *msg, char bd[SIZE][SIZE], double *timeout)
+{
+    cJSON *jboard = cJSON_GetObjectItemCaseSensitive(msg,"board");
+    cJSON *jtimeout = cJSON_GetObjectItemCaseSensitive(msg,"timeout");
+    if (!cJSON_IsArray(jboard) || !cJSON_IsNumber(jtimeout)) {
+        fprintf(stderr,"[Client] Invalid your_turn format\n");
+        return 0;
+    }
+    for (int i = 0; i < SIZE; ++i) {
+        cJSON *row = cJSON_GetArrayItem(jboard, i);
+        if (!cJSON_IsString(row) || strlen(row->valuestring) < SIZE) {
+            fprintf(stderr,"[Client] Invalid your_turn format\n");
+            return 0;
         }
+        memcpy(bd[i], row->valuestring, SIZE);
     }
+    *timeout = jtimeout->valuedouble;
+    return 1;
+}
+
+/* ───── 전송 ────────────────────────────────────────────────────── */
+static int send_all(int sockfd, const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(sockfd, buf, len, 0);
+        if (n < 0) return -1;
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* move 응답: 고정 버퍼에 개행까지 만들어 send 한 번.  패스는 좌표 전부 0 */
+static int send_move(int sockfd, const char *username,
+                     int r1, int c1, int r2, int c2)
+{
+    char buf[160];
+    if (r1 < 0) r1 = c1 = r2 = c2 = -1;
+    int len = snprintf(buf, sizeof(buf),
+                       "{\"type\":\"move\",\"username\":\"%s\","
+                       "\"sx\":%d,\"sy\":%d,\"tx\":%d,\"ty\":%d}\n",
+                       username, r1 + 1, c1 + 1, r2 + 1, c2 + 1);
+    if (send_all(sockfd, buf, len) < 0) {
+        perror("[Client] send move failed");
+        return -1;
+    }
+    return 0;
 }
 
 /* ───── send_json ───────────────────────────────────────────────── */
@@ -107,342 +392,429 @@ static int send_json(int sockfd, cJSON *msg)
         fprintf(stderr, "[Client] cJSON_PrintUnformatted failed\n");
         return -1;
     }
-    size_t len = strlen(out);
-    if (send(sockfd, out, len, 0) < 0) {
+    // 본문과 개행을 writev 한 번으로
+    struct iovec iov[2] = {
+        { out, strlen(out) },
+        { (char *)"\n", 1 },
+    };
+    ssize_t n = writev(sockfd, iov, 2);
+    if (n != (ssize_t)(iov[0].iov_len + 1)) {
         perror("[Client] send json failed");
-        free(out);
-        return -1;
-    }
-    if (send(sockfd, "\n", 1, 0) < 0) {
-        perror("[Client] send newline failed");
-        free(out);
+        cJSON_free(out);
         return -1;
     }
-    free(out);
+    cJSON_free(out);
     return 0;
 }
 
 /* =================================================================
-*                  시간 제한용 유틸리티
+*                  탐색 (engine.c)
 * =================================================================*/
-static struct timespec start_time;
-static const double TIME_LIMIT = 2.9;  // 2.9초 후 탐색 중단
+static Engine *engine;
+static int     ponder_enabled = 0;  /* -ponder 옵션 */
 
-static double elapsed_time()
+/* 탐색 결과 한 줄: 깊이·점수·노드·PV, 좌표는 1부터 (tournament 가 읽는다).
+   who 는 다중 대국의 게임 이름 (NULL 이면 "[Client]") */
+static void print_result(const char *who, const EngineResult *res)
 {
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-    return (now.tv_sec - start_time.tv_sec)
-        + (now.tv_nsec - start_time.tv_nsec) * 1e-9;
+    printf(who ? "[Client %s]" : "[Client]", who);
+    if (res->book || res->cached) {
+        printf(" %s (%d,%d)->(%d,%d) score %d depth %d\n", res->book ? "book" : "cache",
+               res->move.r1 + 1, res->move.c1 + 1, res->move.r2 + 1, res->move.c2 + 1,
+               res->score, res->depth);
+        return;
+    }
+    if (res->solved) {
+        printf(" endgame %s %+d (%s) nodes %llu\n",
+               res->score > 0 ? "win" : res->score < 0 ? "loss" : "draw", res->score,
+               res->solved == 2 ? "exact" : "bound", (unsigned long long)res->nodes);
+        return;
+    }
+    printf(" depth %d score %d nodes %llu pv",
+           res->depth, res->score, (unsigned long long)res->nodes);
+    for (int k = 0; k < res->pv_len; ++k)
+        printf(" (%d,%d)->(%d,%d)", res->pv[k].r1 + 1, res->pv[k].c1 + 1,
+               res->pv[k].r2 + 1, res->pv[k].c2 + 1);
+    putchar('\n');
 }
 
-static int time_exceeded()
+/* 한 수 두고 응답, 필요하면 상대 차례 동안 pondering 시작 */
+static void play_turn(int sockfd, const char *username, char my_color,
+                      char bd[SIZE][SIZE], double timeout)
 {
-    return elapsed_time() >= TIME_LIMIT;
+    EngineResult res;
+    engine_search(engine, bd, my_color, timeout, &res);
+    print_result(NULL, &res);
+    EngineMove m = res.move;
+    send_move(sockfd, username, m.r1, m.c1, m.r2, m.c2);
+    if (ponder_enabled) engine_ponder_start(engine, bd, my_color, m.r1, m.c1, m.r2, m.c2);
 }
 
 /* =================================================================
-*                        AI  (Iterative Deepening + α-β 가지치기)
+*                  다중 대국 (-games N)
+*
+*  한 프로세스가 서버 연결 N 개를 epoll 하나로 들고 있는다.  소켓은
+*  모두 이 루프 스레드만 읽고 쓴다.
+*   - 연결마다 Game (상태, 줄 버퍼, 탐색 작업 칸 하나).  게임 하나에
+*     엔진·스레드를 두지 않으므로 쉬는 게임은 작업 칸의 EngineResult
+*     (약 18 KB) 와 줄 버퍼만 든다.
+*   - connect 는 non-blocking 이라 accept 를 기다리는 연결이 있어도
+*     이미 시작한 게임은 계속 돈다 (register 는 EPOLLOUT 에서).
+*   - your_turn 이 오면 작업을 풀 큐에 넣고, 엔진을 하나씩 가진 탐색
+*     worker (-workers M, 기본 코어 수) 가 꺼내 둔다.  수를 받은 시각부터
+*     timeout 을 재므로 큐에서 기다린 만큼 탐색 시간이 준다 (게임별 마감).
+*   - 끝난 작업은 done 목록에 넣고 eventfd 로 루프를 깨워 수를 보낸다.
+*  사용자 이름은 <username>1 ~ <username>N.  pondering 은 하지 않는다.
 * =================================================================*/
-static const int DR[8] = { -1,-1,-1, 0, 0, 1, 1, 1 };
-static const int DC[8] = { -1, 0, 1,-1, 1,-1, 0, 1 };
-
-/* 보드 복사 */
-static inline void copy_board(char dst[SIZE][SIZE], char src[SIZE][SIZE])
+#define MIN_SEARCH_TIME 0.05    /* 큐에서 마감을 거의 다 쓴 작업에도 주는 시간 (초) */
+
+enum { G_CONNECT, G_REGISTER, G_WAIT_START, G_PLAYING, G_CLOSED };
+
+typedef struct Game {
+    int          fd;
+    int          state;
+    int          busy;              /* 작업이 풀에 있음 (루프 스레드만 읽고 쓴다) */
+    char         username[32];
+    char         my_color;
+    LineBuf      rx;
+    /* 탐색 작업: 게임마다 동시에 하나뿐이라 여기에 둔다 */
+    char         bd[SIZE][SIZE];
+    double       timeout;
+    struct timespec arrival;        /* your_turn 을 받은 시각 */
+    EngineResult res;
+    /* 탐색 중에 온 your_turn: 가장 최근 것 하나만 남겨 작업이 끝나면 돌린다 */
+    int          pending;
+    char         pend_bd[SIZE][SIZE];
+    double       pend_timeout;
+    struct timespec pend_arrival;
+    struct Game *next;              /* 풀 큐 / done 목록 */
+} Game;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    Game           *head, *tail;    /* 기다리는 작업 (FIFO) */
+    Game           *done;           /* 끝난 작업 */
+    int             wake_fd;        /* eventfd: done 이 생기면 루프를 깨운다 */
+    int             quit;
+} Pool;
+
+typedef struct {
+    pthread_t tid;
+    Pool     *pool;
+    Engine   *engine;
+} PoolWorker;
+
+static double seconds_since(const struct timespec *t)
 {
-    memcpy(dst, src, SIZE * SIZE);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - t->tv_sec) + (now.tv_nsec - t->tv_nsec) * 1e-9;
 }
 
-/* 주어진 이동을 보드에 적용 (점프인지 아닌지 구분) */
-static void apply_move_sim(char bd[SIZE][SIZE],
-                        int r1,int c1,int r2,int c2,
-                        char me,int is_jump)
+static void *pool_worker(void *arg)
 {
-    if (is_jump) bd[r1][c1] = '.';
-    bd[r2][c2] = me;
-    char opp = (me == 'R' ? 'B' : 'R');
-    for (int d = 0; d < 8; ++d) {
-        int nr = r2 + DR[d], nc = c2 + DC[d];
-        if (0 <= nr && nr < SIZE && 0 <= nc && nc < SIZE && bd[nr][nc] == opp)
-            bd[nr][nc] = me;
+    PoolWorker *pw = arg;
+    Pool *pool = pw->pool;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->head && !pool->quit)
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        Game *g = pool->head;
+        if (!g) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        pool->head = g->next;
+        if (!pool->head) pool->tail = NULL;
+        pthread_mutex_unlock(&pool->lock);
+
+        // 게임별 마감: 받은 뒤 큐에서 보낸 시간을 뺀다
+        double timeout = engine_timeout_secs(g->timeout);
+        if (timeout > 0) {
+            timeout -= seconds_since(&g->arrival);
+            if (timeout < MIN_SEARCH_TIME) timeout = MIN_SEARCH_TIME;
+        }
+        engine_search(pw->engine, g->bd, g->my_color, timeout, &g->res);
+
+        pthread_mutex_lock(&pool->lock);
+        g->next = pool->done;
+        pool->done = g;
+        pthread_mutex_unlock(&pool->lock);
+        uint64_t one = 1;
+        if (write(pool->wake_fd, &one, sizeof(one)) < 0)
+            perror("[Client] eventfd write");
     }
 }
 
-/* 보드 평가 함수: 말 수 차이 + 모빌리티 차이 (원본과 동일) */
-static int mobility(char bd[SIZE][SIZE], char me)
+static void pool_submit(Pool *pool, Game *g)
 {
-    int cnt = 0;
-    for (int r = 0; r < SIZE; ++r) {
-        for (int c = 0; c < SIZE; ++c) {
-            if (bd[r][c] == me) {
-                for (int d = 0; d < 8; ++d) {
-                    int nr = r + DR[d], nc = c + DC[d];
-                    for (int step = 1; step <= 2; ++step,
-                        nr += DR[d], nc += DC[d]) {
-                        if (0 <= nr && nr < SIZE && 0 <= nc && nc < SIZE
-                            && bd[nr][nc] == '.') {
-                            ++cnt; 
-                            goto NEXT_CELL; 
-                        }
-                    }
-                }
-            }
-            NEXT_CELL: ;
-        }
-    }
-    return cnt;
+    g->busy = 1;
+    g->next = NULL;
+    pthread_mutex_lock(&pool->lock);
+    if (pool->tail) pool->tail->next = g;
+    else            pool->head = g;
+    pool->tail = g;
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
 }
 
-static int evaluate_board(char bd[SIZE][SIZE], char me)
+/* 서버에 연결한 소켓.  flags 에 SOCK_NONBLOCK 이면 connect 가 끝나기를
+   기다리지 않는다 (EPOLLOUT 로 끝남을 알 수 있다).  실패하면 -1 */
+static int connect_server(const char *ip, int port, int flags)
 {
-    char opp = (me == 'R' ? 'B' : 'R');
-    int my_cnt = 0, opp_cnt = 0;
-    for (int i = 0; i < SIZE; ++i) {
-        for (int j = 0; j < SIZE; ++j) {
-            if      (bd[i][j] == me)  ++my_cnt;
-            else if (bd[i][j] == opp) ++opp_cnt;
-        }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    if (inet_pton(AF_INET, ip, &addr.sin_addr) <= 0) {
+        fprintf(stderr, "[Client] Invalid address: %s\n", ip);
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM | flags, 0);
+    if (fd < 0) {
+        perror("[Client] socket creation failed");
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0
+        && !((flags & SOCK_NONBLOCK) && errno == EINPROGRESS)) {
+        perror("[Client] connect failed");
+        close(fd);
+        return -1;
     }
-    int piece_diff = my_cnt - opp_cnt;
-    int my_mob = mobility(bd, me);
-    int opp_mob = mobility(bd, opp);
-    int mob_diff = my_mob - opp_mob;
-    return piece_diff * 100 + mob_diff * 10;
+    return fd;
 }
 
-/* 말이 아직 존재하는지 검사 (턴 건너뛰기 여부 체크) */
-static int has_moves(char bd[SIZE][SIZE], char player)
+/* 연결을 닫는다.  작업이 풀에 있으면 epoll 에서만 빼 두고 끝날 때 닫는다 */
+static void game_close(int epfd, Game *g, int *live)
 {
-    for (int r = 0; r < SIZE; ++r) {
-        for (int c = 0; c < SIZE; ++c) {
-            if (bd[r][c] == player) {
-                for (int d = 0; d < 8; ++d) {
-                    int nr = r + DR[d], nc = c + DC[d];
-                    for (int step = 1; step <= 2; ++step,
-                        nr += DR[d], nc += DC[d]) {
-                        if (nr < 0 || nr >= SIZE || nc < 0 || nc >= SIZE)
-                            break;
-                        if (bd[nr][nc] == '.') return 1;
-                    }
-                }
-            }
-        }
+    if (g->state != G_CLOSED) {
+        g->state = G_CLOSED;
+        epoll_ctl(epfd, EPOLL_CTL_DEL, g->fd, NULL);
     }
-    return 0;
+    if (g->busy || g->fd < 0) return;
+    close(g->fd);
+    g->fd = -1;
+    --*live;
 }
 
-/* ====================
-α-β 가지치기 탐색 (negamax 형태)
-==================== */
-static int alpha_beta(char bd[SIZE][SIZE],
-                    char me, char player,
-                    int depth, int alpha, int beta)
+/* connect 를 시작해 EPOLLOUT 을 기다린다.  실패하면 -1 */
+static int game_connect(int epfd, Game *g, const char *ip, int port)
 {
-    if (time_exceeded()) {
-        return evaluate_board(bd, me);
+    g->state = G_CONNECT;
+    g->fd = connect_server(ip, port, SOCK_NONBLOCK);
+    if (g->fd < 0) return -1;
+    struct epoll_event ev = { .events = EPOLLOUT, .data.ptr = g };
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, g->fd, &ev);
+}
+
+/* connect 가 끝났다 (EPOLLOUT).  register 를 보내고 읽기 대기로, 실패하면 0 */
+static int game_connected(int epfd, Game *g)
+{
+    int err = 0;
+    socklen_t elen = sizeof(err);
+    if (getsockopt(g->fd, SOL_SOCKET, SO_ERROR, &err, &elen) < 0) err = errno;
+    if (err) {
+        fprintf(stderr, "[Client %s] connect failed: %s\n", g->username, strerror(err));
+        return 0;
     }
-    if (depth == 0) {
-        return evaluate_board(bd, me);
+    // 읽기는 MSG_DONTWAIT 로 하므로, 짧은 쓰기를 위해 blocking 으로 되돌린다
+    fcntl(g->fd, F_SETFL, fcntl(g->fd, F_GETFL) & ~O_NONBLOCK);
+    cJSON *reg = cJSON_CreateObject();
+    cJSON_AddStringToObject(reg, "type", "register");
+    cJSON_AddStringToObject(reg, "username", g->username);
+    int sent = send_json(g->fd, reg);
+    json_delete(reg);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = g };
+    if (sent < 0 || epoll_ctl(epfd, EPOLL_CTL_MOD, g->fd, &ev) < 0) return 0;
+    g->state = G_REGISTER;
+    return 1;
+}
+
+/* your_turn: 작업이 없으면 바로 풀에, 탐색 중이면 (서버가 다시 보낸 경우)
+   가장 최근 보드로 남겨 두고 작업이 끝날 때 돌린다 */
+static void game_turn(Pool *pool, Game *g, char bd[SIZE][SIZE], double timeout)
+{
+    if (g->busy) {
+        memcpy(g->pend_bd, bd, sizeof(g->pend_bd));
+        g->pend_timeout = timeout;
+        clock_gettime(CLOCK_MONOTONIC, &g->pend_arrival);
+        g->pending = 1;
+        return;
     }
+    memcpy(g->bd, bd, sizeof(g->bd));
+    g->timeout = timeout;
+    clock_gettime(CLOCK_MONOTONIC, &g->arrival);
+    pool_submit(pool, g);
+}
 
-    char opp = (player == 'R' ? 'B' : 'R');
+/* 한 줄 처리.  게임이 끝났으면 0 */
+static int game_message(Pool *pool, Game *g, char *line, size_t len)
+{
+    char bd[SIZE][SIZE];
+    double timeout;
+    if (g->state == G_PLAYING && parse_your_turn(line, bd, &timeout)) {
+        game_turn(pool, g, bd, timeout);
+        return 1;
+    }
 
-    // 만약 현재 플레이어가 둘 수 없으면(턴 건너뛰기 검사)
-    if (!has_moves(bd, player)) {
-        if (!has_moves(bd, opp)) {
-            // 양쪽 모두 못 두면 게임 종료, 터미널 스코어
-            int my_cnt = 0, opp_cnt = 0;
-            for (int i = 0; i < SIZE; ++i) {
-                for (int j = 0; j < SIZE; ++j) {
-                    if      (bd[i][j] == me)  ++my_cnt;
-                    else if (bd[i][j] == opp) ++opp_cnt;
-                }
-            }
-            if      (my_cnt > opp_cnt) return  INF/2;
-            else if (my_cnt < opp_cnt) return -INF/2;
-            else                        return  0;
-        }
-        // 상대만 수가 있으면, 내 차례 건너뛰기
-        int val = -alpha_beta(bd, me, opp, depth, -beta, -alpha);
-        return val;
-    }
-
-    int best_val = -INF;
-    // 모든 합법 수들을 “정적 평가” 기준으로 정렬하여 순차 탐색
-    //  (Move‐Ordering)
-    typedef struct {
-        int r1, c1, r2, c2;
-        int static_score;
-    } Move;
-    Move all_moves[256];
-    int move_cnt = 0;
-
-    // (1) 가능한 모든 수 생성 & 정적 평가값(static_score) 계산
-    for (int r = 0; r < SIZE; ++r) {
-        for (int c = 0; c < SIZE; ++c) {
-            if (bd[r][c] != player) continue;
-            for (int d = 0; d < 8; ++d) {
-                int nr = r + DR[d], nc = c + DC[d];
-                for (int step = 1; step <= 2; ++step,
-                    nr += DR[d], nc += DC[d]) {
-                    if (nr < 0 || nr >= SIZE || nc < 0 || nc >= SIZE) break;
-                    if (bd[nr][nc] != '.') continue;
-
-                    // 임시 보드에 한 수 적용
-                    char sim[SIZE][SIZE];
-                    copy_board(sim, bd);
-                    apply_move_sim(sim, r, c, nr, nc, player, step == 2);
-                    // 정적 평가: evaluate_board(…, player) 사용
-                    int st_score = evaluate_board(sim, player);
-                    all_moves[move_cnt++] = (Move){r, c, nr, nc, st_score};
-                }
-            }
+    cJSON *msg = cJSON_ParseWithLength(line, len);
+    if (!msg) {
+        json_delete(NULL);
+        fprintf(stderr, "[Client %s] cJSON_Parse error, ignored: %s\n", g->username, line);
+        return 1;
+    }
+    cJSON *tp = cJSON_GetObjectItemCaseSensitive(msg,"type");
+    int alive = 1;
+    if (!cJSON_IsString(tp)) {
+        // 무시
+    } else if (g->state == G_REGISTER) {
+        if (strcmp(tp->valuestring,"register_ack") == 0) {
+            g->state = G_WAIT_START;
+        } else {
+            fprintf(stderr, "[Client %s] register failed.\n", g->username);
+            alive = 0;
         }
+    } else if (strcmp(tp->valuestring,"game_start") == 0) {
+        cJSON *fst = cJSON_GetObjectItemCaseSensitive(msg,"first_player");
+        g->my_color = cJSON_IsString(fst) && strcmp(fst->valuestring, g->username) == 0 ? 'R' : 'B';
+        g->state = G_PLAYING;
+    } else if (strcmp(tp->valuestring,"your_turn") == 0) {
+        if (g->state == G_PLAYING && json_your_turn(msg, bd, &timeout))
+            game_turn(pool, g, bd, timeout);
+    } else if (strcmp(tp->valuestring,"game_over") == 0) {
+        printf("[Client %s] Game over!\n", g->username);
+        alive = 0;
     }
+    json_delete(msg);
+    return alive;
+}
 
-    // (2) 정적 평가(static_score) 내림차순으로 정렬(버블 정렬로 간단 구현)
-    for (int i = 0; i < move_cnt; ++i) {
-        for (int j = i + 1; j < move_cnt; ++j) {
-            if (all_moves[j].static_score > all_moves[i].static_score) {
-                Move tmp = all_moves[i];
-                all_moves[i] = all_moves[j];
-                all_moves[j] = tmp;
-            }
+static int multi_main(const char *ip, int port, const char *username,
+                      const EngineConfig *cfg, int ngames, int nworkers)
+{
+    Game *games = calloc(ngames, sizeof(Game));
+    PoolWorker *workers = calloc(nworkers, sizeof(PoolWorker));
+    Pool pool = { .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+    int epfd = epoll_create1(0);
+    pool.wake_fd = eventfd(0, EFD_NONBLOCK);
+    if (!games || !workers || epfd < 0 || pool.wake_fd < 0) {
+        perror("[Client] multi-game setup failed");
+        exit(EXIT_FAILURE);
+    }
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+    epoll_ctl(epfd, EPOLL_CTL_ADD, pool.wake_fd, &ev);
+
+    for (int i = 0; i < nworkers; ++i) {
+        workers[i].pool = &pool;
+        workers[i].engine = engine_create(cfg);
+        if (!workers[i].engine
+            || pthread_create(&workers[i].tid, NULL, pool_worker, &workers[i]) != 0) {
+            fprintf(stderr, "[Client] engine init failed\n");
+            exit(EXIT_FAILURE);
         }
     }
 
-    // (3) α‐β 탐색: ordering된 순서대로 탐색
-    for (int i = 0; i < move_cnt; ++i) {
-        int r1 = all_moves[i].r1, c1 = all_moves[i].c1;
-        int r2 = all_moves[i].r2, c2 = all_moves[i].c2;
-        char sim[SIZE][SIZE];
-        copy_board(sim, bd);
-        apply_move_sim(sim, r1, c1, r2, c2, player,
-                    (abs(r1 - r2) > 1 || abs(c1 - c2) > 1));
-
-        int val = -alpha_beta(sim, me, opp, depth - 1, -beta, -alpha);
-        if (val > best_val) best_val = val;
-        if (best_val > alpha) alpha = best_val;
-        if (alpha >= beta) break;
-        if (time_exceeded()) break;
+    int live = 0;
+    for (int i = 0; i < ngames; ++i) {
+        Game *g = &games[i];
+        snprintf(g->username, sizeof(g->username), "%.20s%d", username, i + 1);
+        // 서버 accept 큐가 차 있어도 기다리지 않는다: 먼저 시작한 게임을
+        // 돌리는 동안 connect 가 끝나면 EPOLLOUT 에서 register 를 보낸다
+        if (game_connect(epfd, g, ip, port) < 0) {
+            if (g->fd >= 0) close(g->fd);
+            g->fd = -1;
+            g->state = G_CLOSED;
+            continue;
+        }
+        ++live;
     }
-
-    return best_val;
-}
-
-/* ====================
-Iterative Deepening을 이용한 move_generate
-==================== */
-static void move_generate(char board[SIZE][SIZE], char me,
-                        int *out_r1, int *out_c1,
-                        int *out_r2, int *out_c2)
-{
-    typedef struct {
-    int r1, c1, r2, c2;
-    int static_score;
-    } Move; 
-
-    clock_gettime(CLOCK_MONOTONIC, &start_time);
-
-    char opp = (me == 'R' ? 'B' : 'R');
-    int best_score_overall = -INF;
-    int best_r1 = -1, best_c1 = -1, best_r2 = -1, best_c2 = -1;
-    int move_cnt = 0;
-    Move all_moves[256];
-
-    // 시간 내에 가능한 만큼 깊이(depth)를 1씩 늘리며 탐색
-    for (int depth = 1; depth <= 8; ++depth) {
-        if (time_exceeded()) break;
-
-        int local_best_score = -INF;
-        int local_r1 = -1, local_c1 = -1, local_r2 = -1, local_c2 = -1;
-
-        // 현재 depth에서 가능한 모든 수를 한 번만 훑어보고 정적 점수로 정렬
-        typedef struct {
-            int r1, c1, r2, c2;
-            int static_score;
-        } Move;
-        
-        Move all_moves[256];
-        int move_cnt = 0;
-
-        // (1) 후보 생성 & 정적 평가
-        for (int r = 0; r < SIZE; ++r) {
-            for (int c = 0; c < SIZE; ++c) {
-                if (board[r][c] != me) continue;
-                for (int d = 0; d < 8; ++d) {
-                    int nr = r + DR[d], nc = c + DC[d];
-                    for (int step = 1; step <= 2; ++step,
-                        nr += DR[d], nc += DC[d]) {
-                        if (nr < 0 || nr >= SIZE || nc < 0 || nc >= SIZE) break;
-                        if (board[nr][nc] != '.') continue;
-
-                        char sim[SIZE][SIZE];
-                        copy_board(sim, board);
-                        apply_move_sim(sim, r, c, nr, nc, me,
-                                    (abs(r - nr) > 1 || abs(c - nc) > 1));
-                        int st_score = evaluate_board(sim, me);
-                        all_moves[move_cnt++] = (Move){r, c, nr, nc, st_score};
+    printf("[Client %s] connecting %d games to %s:%d, %d search workers\n",
+           username, live, ip, port, nworkers);
+
+    struct epoll_event events[64];
+    while (live > 0) {
+        int n = epoll_wait(epfd, events, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("[Client] epoll_wait");
+            break;
+        }
+        for (int k = 0; k < n; ++k) {
+            Game *g = events[k].data.ptr;
+            if (!g) {
+                // 끝난 탐색: 수를 보낸다 (게임이 그새 끝났으면 닫기만)
+                uint64_t cnt;
+                if (read(pool.wake_fd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN)
+                    perror("[Client] eventfd read");
+                pthread_mutex_lock(&pool.lock);
+                Game *done = pool.done;
+                pool.done = NULL;
+                pthread_mutex_unlock(&pool.lock);
+                while (done) {
+                    Game *d = done;
+                    done = d->next;
+                    d->busy = 0;
+                    if (d->state != G_PLAYING) {
+                        game_close(epfd, d, &live);
+                        continue;
                     }
+                    // 탐색 중에 your_turn 이 또 왔다: 같은 보드면 방금 결과가
+                    // 그 답이고, 다른 보드면 낡은 결과를 버리고 새 보드를 읽는다
+                    if (d->pending) {
+                        d->pending = 0;
+                        if (memcmp(d->pend_bd, d->bd, sizeof(d->bd)) != 0) {
+                            memcpy(d->bd, d->pend_bd, sizeof(d->bd));
+                            d->timeout = d->pend_timeout;
+                            d->arrival = d->pend_arrival;
+                            pool_submit(&pool, d);
+                            continue;
+                        }
+                    }
+                    EngineMove m = d->res.move;
+                    print_result(d->username, &d->res);
+                    if (send_move(d->fd, d->username, m.r1, m.c1, m.r2, m.c2) < 0)
+                        game_close(epfd, d, &live);
                 }
+                continue;
             }
-        }
-
-        // (2) 정렬: 정적 점수 내림차순
-        for (int i = 0; i < move_cnt; ++i) {
-            for (int j = i + 1; j < move_cnt; ++j) {
-                if (all_moves[j].static_score > all_moves[i].static_score) {
-                    Move tmp = all_moves[i];
-                    all_moves[i] = all_moves[j];
-                    all_moves[j] = tmp;
-                }
+            if (g->state == G_CLOSED) continue;
+            if (g->state == G_CONNECT) {
+                if (!game_connected(epfd, g)) game_close(epfd, g, &live);
+                continue;
             }
-        }
-
-        // (3) α‐β 탐색 (logging 최적 수를 기록)
-        for (int i = 0; i < move_cnt; ++i) {
-            if (time_exceeded()) break;
-
-            int r1 = all_moves[i].r1, c1 = all_moves[i].c1;
-            int r2 = all_moves[i].r2, c2 = all_moves[i].c2;
-            char sim[SIZE][SIZE];
-            copy_board(sim, board);
-            apply_move_sim(sim, r1, c1, r2, c2, me,
-                        (abs(r1 - r2) > 1 || abs(c1 - c2) > 1));
-
-            int score = -alpha_beta(sim, me, opp, depth - 1, -INF, +INF);
-            if (score > local_best_score) {
-                local_best_score = score;
-                local_r1 = r1; local_c1 = c1;
-                local_r2 = r2; local_c2 = c2;
+            ssize_t got = line_fill(&g->rx, g->fd, MSG_DONTWAIT);
+            if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+                continue;
+            if (got <= 0) {
+                fprintf(stderr, "[Client %s] Server closed.\n", g->username);
+                game_close(epfd, g, &live);
+                continue;
             }
+            size_t len;
+            char *line;
+            while (g->state != G_CLOSED && (line = line_next(&g->rx, &len)))
+                if (!game_message(&pool, g, line, len))
+                    game_close(epfd, g, &live);
         }
-
-        // (4) 이 깊이 탐색을 완료했다면, 최고 결과를 “전체 최적”으로 갱신
-        if (!time_exceeded() && local_r1 >= 0) {
-            best_score_overall = local_best_score;
-            best_r1 = local_r1; best_c1 = local_c1;
-            best_r2 = local_r2; best_c2 = local_c2;
-        } else {
-            // 시간이 다 되었거나 후보가 없으면 종료
-            break;
-        }
+        fflush(stdout);
     }
 
-    // move_cnt, all_moves가 남아 있다면 무조건 하나라도 두기
-    if (move_cnt > 0 && best_r1 < 0) {
-        // 후보가 있었는데 탐색이 안 끝나서 best_r1이 갱신되지 않은 경우
-        best_r1 = all_moves[0].r1;
-        best_c1 = all_moves[0].c1;
-        best_r2 = all_moves[0].r2;
-        best_c2 = all_moves[0].c2;
+    pthread_mutex_lock(&pool.lock);
+    pool.quit = 1;
+    pthread_cond_broadcast(&pool.cond);
+    pthread_mutex_unlock(&pool.lock);
+    for (int i = 0; i < nworkers; ++i) {
+        pthread_join(workers[i].tid, NULL);
+        engine_destroy(workers[i].engine);
     }
-
-    // 최종 선택 move를 out 변수에 저장
-    *out_r1 = best_r1;
-    *out_c1 = best_c1;
-    *out_r2 = best_r2;
-    *out_c2 = best_c2;
+    json_report(username);
+    for (int i = 0; i < ngames; ++i) free(games[i].rx.buf);
+    free(games);
+    free(workers);
+    close(pool.wake_fd);
+    close(epfd);
+    return 0;
 }
 
 /* =================================================================
@@ -453,28 +825,32 @@ int main(int argc, char *argv[])
     char server_ip[INET_ADDRSTRLEN] = {0};
     int  server_port = 0;
     char username[32] = {0};
-
-    parse_args(argc, argv, server_ip, &server_port, username);
-
-    int sockfd;
-    struct sockaddr_in serv_addr;
-    if ((sockfd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
-        perror("[Client] socket creation failed");
-        exit(EXIT_FAILURE);
+    EngineConfig cfg = ENGINE_CONFIG_DEFAULT;
+    int  games = 1, workers = 0;
+
+    parse_args(argc, argv, server_ip, &server_port, username,
+               &cfg.hash_mb, &cfg.threads, &ponder_enabled, &cfg.endgame_empties,
+               &cfg.stats_log, &cfg.eval_file, &cfg.book_file,
+               &cfg.cache_file, &cfg.cache_mb, &cfg.mcts, &games, &workers);
+    json_init();
+    if (games > 1) {
+        if (workers < 1) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (workers > games) workers = games;
+        if (workers < 1)     workers = 1;
+        return multi_main(server_ip, server_port, username, &cfg, games, workers);
     }
-    memset(&serv_addr, 0, sizeof(serv_addr));
-    serv_addr.sin_family = AF_INET;
-    serv_addr.sin_port   = htons(server_port);
-    if (inet_pton(AF_INET, server_ip, &serv_addr.sin_addr) <= 0) {
-        fprintf(stderr, "[Client] Invalid address: %s\n", server_ip);
-        close(sockfd);
-        exit(EXIT_FAILURE);
-    }
-    if (connect(sockfd, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) < 0) {
-        perror("[Client] connect failed");
-        close(sockfd);
+    engine = engine_create(&cfg);
+    if (!engine) {
+        fprintf(stderr, "[Client] engine init failed\n");
         exit(EXIT_FAILURE);
     }
+    if (cfg.eval_file)
+        printf("[Client] eval %s (%s)\n", cfg.eval_file, nn_simd_name());
+    if (cfg.mcts)
+        printf("[Client] MCTS search, %zu MB node arena\n", cfg.hash_mb);
+
+    int sockfd = connect_server(server_ip, server_port, 0);
+    if (sockfd < 0) exit(EXIT_FAILURE);
     printf("[Client %s] Connected to %s:%d\n",
         username, server_ip, server_port);
 
@@ -483,9 +859,10 @@ int main(int argc, char *argv[])
     cJSON_AddStringToObject(reg, "type", "register");
     cJSON_AddStringToObject(reg, "username", username);
     send_json(sockfd, reg); 
-    cJSON_Delete(reg);
+    json_delete(reg);
 
-    cJSON *res = recv_json(sockfd);
+    LineBuf rx = { 0 };
+    cJSON *res = recv_json(&rx, sockfd);
     if (!res) { 
         fprintf(stderr,"[Client] No response to register.\n"); 
         close(sockfd);
@@ -494,14 +871,14 @@ int main(int argc, char *argv[])
     cJSON *rtype = cJSON_GetObjectItemCaseSensitive(res,"type");
     if (!cJSON_IsString(rtype) || strcmp(rtype->valuestring,"register_ack")!=0) {
         fprintf(stderr,"[Client] register failed.\n");
-        cJSON_Delete(res);
+        json_delete(res);
         close(sockfd);
         exit(EXIT_FAILURE);
     }
-    cJSON_Delete(res);
+    json_delete(res);
 
     /* ---------- wait game_start ---------- */
-    cJSON *gst = recv_json(sockfd);
+    cJSON *gst = recv_json(&rx, sockfd);
     if (!gst) {
         fprintf(stderr,"[Client] No game_start received.\n");
         close(sockfd);
@@ -509,71 +886,61 @@ int main(int argc, char *argv[])
     }
     cJSON *fst = cJSON_GetObjectItemCaseSensitive(gst,"first_player");
     char my_color = (strcmp(fst->valuestring, username)==0 ? 'R':'B');
-    cJSON_Delete(gst);
+    json_delete(gst);
 
     /* ---------- main game loop ---------- */
     while (1) {
-        cJSON *msg = recv_json(sockfd);
-        if (!msg) { 
+        size_t len;
+        char *line = recv_line(&rx, sockfd, &len);
+        engine_ponder_stop(engine);
+        if (!line) { 
             fprintf(stderr,"[Client] Server closed.\n"); 
             break; 
         }
 
+        char bd[SIZE][SIZE];
+        double timeout;
+
+        /* === your_turn (빠른 경로: 파싱 없이 바로 보드로) === */
+        if (parse_your_turn(line, bd, &timeout)) {
+            play_turn(sockfd, username, my_color, bd, timeout);
+            continue;
+        }
+
+        cJSON *msg = cJSON_ParseWithLength(line, len);
+        if (!msg) {
+            json_delete(NULL);
+            fprintf(stderr, "[Client] cJSON_Parse error, ignored: %s\n", line);
+            continue;
+        }
         cJSON *tp = cJSON_GetObjectItemCaseSensitive(msg,"type");
         if (!cJSON_IsString(tp)){
-            cJSON_Delete(msg);
+            json_delete(msg);
             continue;
         }
 
-        /* === your_turn === */
+        /* === your_turn (빠른 경로가 못 읽은 모양) === */
         if (strcmp(tp->valuestring,"your_turn")==0) {
-            cJSON *jboard = cJSON_GetObjectItemCaseSensitive(msg,"board");
-            cJSON *jtimeout = cJSON_GetObjectItemCaseSensitive(msg,"timeout");
-            if (!cJSON_IsArray(jboard) || !cJSON_IsNumber(jtimeout)) {
-                fprintf(stderr,"[Client] Invalid your_turn format\n");
-                cJSON_Delete(msg);
-                continue;
-            }
-            char bd[SIZE][SIZE];
-            for (int i = 0; i < SIZE; ++i) {
-                cJSON *row = cJSON_GetArrayItem(jboard, i);
-                memcpy(bd[i], row->valuestring, SIZE);
-            }
-
-            int r1, c1, r2, c2;
-            move_generate(bd, my_color, &r1, &c1, &r2, &c2);
-
-            cJSON *mv = cJSON_CreateObject();
-            cJSON_AddStringToObject(mv,"type","move");
-            cJSON_AddStringToObject(mv,"username",username);
-            if (r1 < 0) {  /* PASS */
-                cJSON_AddNumberToObject(mv,"sx",0);
-                cJSON_AddNumberToObject(mv,"sy",0);
-                cJSON_AddNumberToObject(mv,"tx",0);
-                cJSON_AddNumberToObject(mv,"ty",0);
-            } else {
-                cJSON_AddNumberToObject(mv,"sx",r1+1);
-                cJSON_AddNumberToObject(mv,"sy",c1+1);
-                cJSON_AddNumberToObject(mv,"tx",r2+1);
-                cJSON_AddNumberToObject(mv,"ty",c2+1);
-            }
-            send_json(sockfd,mv);
-            cJSON_Delete(mv);
-            cJSON_Delete(msg);
+            int ok = json_your_turn(msg, bd, &timeout);
+            json_delete(msg);
+            if (ok) play_turn(sockfd, username, my_color, bd, timeout);
             continue;
         }
 
         /* === game_over === */
         if (strcmp(tp->valuestring,"game_over")==0) {
             puts("[Client] Game over!");
-            cJSON_Delete(msg);
+            json_delete(msg);
             break;
         }
 
         /* 기타 메시지 => 무시 */
-        cJSON_Delete(msg);
+        json_delete(msg);
     }
 
+    json_report(username);
     close(sockfd);
+    free(rx.buf);
+    engine_destroy(engine);
     return 0;
 }
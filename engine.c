@@ -0,0 +1,1789 @@
+/********************************************************************
+ *  engine.c ― OctaFlip 탐색 엔진
+ *             Iterative Deepening + α‐β (Lazy SMP) + 종반 solver
+ *
+ *  client2 / client4 / bench 가 함께 쓴다.  API 는 engine.h 참고.
+ *  엔진 하나가 치환표·탐색 스레드·시간 관리 상태를 모두 가지므로
+ *  한 프로세스에서 여러 엔진을 동시에 돌려도 된다.
+ *
+ *  빌드 (보드 크기는 쓰는 쪽과 같게):
+ *      gcc -c engine.c -O2 -Wall -Wextra -pthread [-DOCTAFLIP_SIZE=N] [-DOCTAFLIP_STATS]
+ *
+ *  -DOCTAFLIP_STATS: 탐색 통계를 세고 EngineConfig.stats_log 파일에
+ *  수·반복마다 JSON 한 줄씩 남긴다.  없으면 세는 코드가 모두 빠진다.
+ *
+ *  EngineConfig.eval_file 을 주면 말단 평가를 evaluate_board 대신
+ *  nnue.c 의 신경망으로 한다 (nnue.c 를 함께 링크).
+ *  EngineConfig.mcts 면 α-β 대신 병렬 MCTS (UCT) 로 수를 고른다.
+ *  EngineConfig.book_file 을 주면 book.c 의 opening book 에 있는 국면은
+ *  탐색 없이 바로 둔다.
+ *  EngineConfig.cache_file 을 주면 cache.c 의 디스크 캐시에서 루트를 찾아
+ *  최선 수를 먼저 읽고, 끝낸 깊이가 더 깊으면 결과를 써 넣는다.
+ *******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <math.h>
+#include "engine.h"
+#include "nnue.h"
+#include "book.h"
+#include "cache.h"
+
+#define INF      1000000000
+_Static_assert(INF / 2 == SCORE_WIN, "engine.h SCORE_WIN != INF / 2");
+
+#ifdef OCTAFLIP_STATS
+#define STAT(w, field)  ((w)->stats.field++)
+#else
+#define STAT(w, field)  ((void)0)
+#endif
+
+/* =================================================================
+*                  비트보드 표
+* =================================================================*/
+bb_t     ADJ[NSQ];
+bb_t     JUMP[NSQ];
+uint64_t ZOB[2][NSQ];
+uint64_t ZOB_FLIP[NSQ];
+uint64_t ZOB_SIDE[2];
+uint8_t  SYM_SQ[SYM_COUNT][NSQ];
+
+static uint64_t splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void init_tables(void)
+{
+    uint64_t seed = 0x0C7AF11BULL;     /* 고정 시드: 실행마다 같은 키 */
+    for (int sq = 0; sq < NSQ; ++sq) {
+        ADJ[sq]  = bb_adjacent(BB_SQ(sq));
+        JUMP[sq] = bb_jumps(BB_SQ(sq));
+        ZOB[RED][sq]  = splitmix64(&seed);
+        ZOB[BLUE][sq] = splitmix64(&seed);
+        ZOB_FLIP[sq]  = ZOB[RED][sq] ^ ZOB[BLUE][sq];
+    }
+    ZOB_SIDE[RED]  = 0;
+    ZOB_SIDE[BLUE] = splitmix64(&seed);
+    for (int sym = 0; sym < SYM_COUNT; ++sym)
+        for (int r = 0; r < SIZE; ++r)
+            for (int c = 0; c < SIZE; ++c) {
+                int rr = (sym & 4) ? c : r, cc = (sym & 4) ? r : c;
+                if (sym & 2) rr = SIZE - 1 - rr;
+                if (sym & 1) cc = SIZE - 1 - cc;
+                SYM_SQ[sym][r * SIZE + c] = (uint8_t)(rr * SIZE + cc);
+            }
+}
+
+void init_bitboards(void)
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, init_tables);
+}
+
+/* 말 배치의 Zobrist 키를 처음부터 */
+static uint64_t pos_key(const Pos *p)
+{
+    uint64_t key = 0;
+    for (int side = RED; side <= BLUE; ++side)
+        for (bb_t b = p->bb[side]; b; )
+            key ^= ZOB[side][bb_pop(&b)];
+    return key;
+}
+
+void board_to_pos(char bd[SIZE][SIZE], Pos *p)
+{
+    p->bb[RED] = p->bb[BLUE] = p->blocked = 0;
+    for (int r = 0; r < SIZE; ++r) {
+        for (int c = 0; c < SIZE; ++c) {
+            bb_t b = BB_SQ(r * SIZE + c);
+            if      (bd[r][c] == 'R') p->bb[RED]  |= b;
+            else if (bd[r][c] == 'B') p->bb[BLUE] |= b;
+            else if (bd[r][c] != '.') p->blocked  |= b;
+        }
+    }
+    p->key = pos_key(p);
+}
+
+void pos_transform(const Pos *src, int sym, Pos *dst)
+{
+    dst->bb[RED]  = bb_transform(src->bb[RED], sym);
+    dst->bb[BLUE] = bb_transform(src->bb[BLUE], sym);
+    dst->blocked  = bb_transform(src->blocked, sym);
+    dst->key      = pos_key(dst);
+}
+
+int pos_canonical(const Pos *p, int side, Pos *out)
+{
+    bb_t own = p->bb[side], opp = p->bb[side ^ 1], blk = p->blocked;
+    int best = 0;
+    // (own, opp, blocked) 사전순 최소.  대개 own 만 비교하고 끝난다
+    for (int sym = 1; sym < SYM_COUNT; ++sym) {
+        bb_t a = bb_transform(p->bb[side], sym);
+        if (a > own) continue;
+        bb_t b = bb_transform(p->bb[side ^ 1], sym);
+        if (a == own && b > opp) continue;
+        bb_t c = bb_transform(p->blocked, sym);
+        if (a == own && b == opp && c >= blk) continue;
+        own = a; opp = b; blk = c;
+        best = sym;
+    }
+    out->bb[RED]  = own;
+    out->bb[BLUE] = opp;
+    out->blocked  = blk;
+    out->key      = pos_key(out);
+    return best;
+}
+
+uint64_t canon_key(const Pos *canon)
+{
+    // 막힌 칸은 말 배치 key 에 없으므로 따로 섞는다 (R·B 가 한 칸에 있는 꼴)
+    uint64_t key = canon->key;
+    for (bb_t b = canon->blocked; b; ) {
+        uint64_t z = ZOB_FLIP[bb_pop(&b)];
+        key ^= z << 1 | z >> 63;
+    }
+    return key;
+}
+
+/* =================================================================
+*                  치환표 (Transposition Table)
+*
+*  64바이트(캐시 라인) 버킷 하나에 16바이트 엔트리 4개.
+*  같은 키면 덮어쓰고, 아니면 (깊이 − 세대 차이) 가 가장 작은 엔트리를
+*  교체한다.  크기는 EngineConfig.hash_mb 로 정하며, 엔진이 살아 있는
+*  동안 계속 유지된다.
+*
+*  모든 탐색 스레드가 락 없이 공유한다: 엔트리에 key 대신 key ^ data 를
+*  저장해 두고, 읽은 check ^ data 가 찾는 키와 다르면(다른 스레드가
+*  쓰는 도중이었으면) 없는 것으로 본다.
+* =================================================================*/
+enum { TT_NONE = 0, TT_UPPER = 1, TT_LOWER = 2, TT_EXACT = 3 };
+
+#define MOVE_NONE   0xFFFF
+#define PACK_MOVE(from, to)  ((uint16_t)((from) | ((to) << 8)))
+#define MOVE_FROM(m)         ((m) & 0xFF)
+#define MOVE_TO(m)           ((m) >> 8)
+
+typedef struct {
+    _Atomic uint64_t check;     /* key ^ data */
+    _Atomic uint64_t data;      /* score:32 | move:16 | depth:8 | gen:6 | bound:2 */
+} TTEntry;
+
+typedef struct {
+    int score, move, depth, bound;
+} TTHit;
+
+#define TT_WAYS 4
+typedef struct {
+    _Alignas(64) TTEntry e[TT_WAYS];
+} TTBucket;
+
+typedef struct {
+    TTBucket *b;
+    size_t    mask;
+    uint8_t   gen;
+} TT;
+
+static int tt_init(TT *tt, size_t mb)
+{
+    size_t n = 1;
+    while (n * 2 * sizeof(TTBucket) <= mb * 1024 * 1024) n *= 2;
+    void *mem = NULL;
+    if (posix_memalign(&mem, 64, n * sizeof(TTBucket)) != 0) {
+        fprintf(stderr, "[Engine] TT allocation failed (%zu MB)\n", mb);
+        return -1;
+    }
+    memset(mem, 0, n * sizeof(TTBucket));
+    tt->b    = mem;
+    tt->mask = n - 1;
+    tt->gen  = 0;
+    return 0;
+}
+
+/* 새 수 탐색 시작: 세대를 올려 지난 턴의 엔트리가 먼저 교체되게 한다 */
+static inline void tt_new_search(TT *tt) { tt->gen = (tt->gen + 1) & 63; }
+
+static inline uint64_t tt_pack(const TT *tt, int score, int move, int depth, int bound)
+{
+    return (uint64_t)(uint32_t)score << 32 | (uint64_t)(uint16_t)move << 16
+         | (uint64_t)(uint8_t)depth << 8 | (uint64_t)((tt->gen << 2) | bound);
+}
+
+static inline int tt_probe(const TT *tt, uint64_t key, TTHit *hit)
+{
+    TTBucket *b = &tt->b[key & tt->mask];
+    for (int i = 0; i < TT_WAYS; ++i) {
+        uint64_t data  = atomic_load_explicit(&b->e[i].data,  memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&b->e[i].check, memory_order_relaxed);
+        if ((check ^ data) != key || (data & 3) == TT_NONE) continue;
+        hit->score = (int32_t)(data >> 32);
+        hit->move  = (data >> 16) & 0xFFFF;
+        hit->depth = (data >> 8) & 0xFF;
+        hit->bound = data & 3;
+        return 1;
+    }
+    return 0;
+}
+
+static void tt_store(TT *tt, uint64_t key, int depth, int score, int bound, int move)
+{
+    TTBucket *b = &tt->b[key & tt->mask];
+    TTEntry *victim = &b->e[0];
+    int victim_val = INF;
+    for (int i = 0; i < TT_WAYS; ++i) {
+        TTEntry *e = &b->e[i];
+        uint64_t data  = atomic_load_explicit(&e->data,  memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&e->check, memory_order_relaxed);
+        if ((check ^ data) == key) {
+            if (move == MOVE_NONE) move = (data >> 16) & 0xFFFF;
+            victim = e;
+            break;
+        }
+        int age = (tt->gen - ((data >> 2) & 63)) & 63;
+        int val = ((data & 3) == TT_NONE) ? -INF : (int)((data >> 8) & 0xFF) - 8 * age;
+        if (val < victim_val) { victim_val = val; victim = e; }
+    }
+    uint64_t data = tt_pack(tt, score, move, depth, bound);
+    atomic_store_explicit(&victim->check, key ^ data, memory_order_relaxed);
+    atomic_store_explicit(&victim->data,  data,       memory_order_relaxed);
+}
+
+/* =================================================================
+*                  엔진 상태
+* =================================================================*/
+typedef struct {
+    uint64_t key;
+    int8_t   lower, upper;          /* 최종 말 수 차이의 하한/상한 (증명된 값만) */
+    uint16_t move;
+} EGEntry;
+
+/* MCTS 노드.  자식은 arena 의 연속 블록 [child, child + nchild) */
+enum { MN_LEAF, MN_BUSY, MN_OPEN, MN_END };
+typedef struct {
+    _Atomic uint32_t visits;        /* virtual loss 포함 */
+    _Atomic uint32_t score;         /* 이 수를 둔 쪽 기준 승 2 / 무 1 / 패 0 합 */
+    _Atomic uint32_t child;         /* 첫 자식 번호 (OPEN 일 때만) */
+    uint16_t         move;          /* PACK_MOVE, 패스면 MOVE_NONE */
+    uint16_t         nchild;
+    _Atomic uint8_t  state;         /* MN_LEAF → (BUSY) → OPEN / END */
+} MNode;
+
+typedef struct Worker Worker;
+
+struct Engine {
+    EngineConfig    cfg;
+    TT              tt;
+    EGEntry        *eg_hash;        /* 종반 solver 전용 표 (처음 쓸 때 할당) */
+    NNWeights      *nn;             /* 신경망 평가 가중치 (NULL = evaluate_board) */
+    Book           *book;           /* opening book (mmap, NULL = 없음) */
+    Cache          *cache;          /* 디스크 국면 캐시 (mmap, NULL = 없음) */
+    MNode          *mcts_nodes;     /* cfg.mcts 일 때 노드 arena (hash_mb 크기) */
+    uint32_t        mcts_cap;
+    _Atomic uint32_t mcts_top;      /* 다음 빈 노드 */
+    atomic_int      mcts_depth;     /* 가장 깊이 내려간 길이 */
+    struct timespec start_time;
+    double          soft_limit;     /* 새 깊이를 시작하지 않는 시각 */
+    double          hard_limit;     /* 탐색을 끊는 시각 */
+    atomic_int      stop;           /* 모든 탐색 스레드 공용 중단 플래그 */
+    int             pondering;
+    pthread_t       ponder_tid;
+    Worker         *workers;        /* cfg.threads 개 */
+    FILE           *stats_fp;       /* -DOCTAFLIP_STATS 빌드의 통계 로그 */
+    int             search_no;      /* engine_search 호출 횟수 (로그용) */
+};
+
+/* =================================================================
+*                  시간 관리
+*
+*  서버가 your_turn 에 실어 보내는 timeout(초)에서 네트워크 지연
+*  여유분을 뺀 것이 hard 마감, 그 안에서 게임 단계에 따라 soft 마감을
+*  정한다.
+*   - hard: 탐색 중이라도 즉시 중단
+*   - soft: 이후로는 새 반복(깊이)을 시작하지 않음
+*   - 최선 수가 여러 반복 동안 그대로면 soft 전이라도 조기 종료
+*  시계는 노드마다 보지 않고 TIME_CHECK_NODES 노드마다 한 번 본다.
+* =================================================================*/
+#define DEFAULT_TIMEOUT   3.0     /* timeout 이 오지 않았을 때 (초) */
+#define LATENCY_MARGIN    0.10    /* 네트워크 지연 여유 (초) */
+#define LATENCY_RATIO     0.01    /* timeout 에 비례하는 추가 여유 */
+#define TIME_CHECK_NODES  1024    /* 시계 확인 주기 (2의 거듭제곱) */
+#define STABLE_ITERS      3       /* 이만큼 최선 수가 그대로면 조기 종료 */
+
+static double elapsed_time(const Engine *e)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - e->start_time.tv_sec)
+        + (now.tv_nsec - e->start_time.tv_nsec) * 1e-9;
+}
+
+/* 한 수의 예산 설정. soft_frac 은 게임 단계별 hard 대비 비율 */
+static void time_init(Engine *e, double timeout, double soft_frac)
+{
+    clock_gettime(CLOCK_MONOTONIC, &e->start_time);
+    if (timeout <= 0) timeout = DEFAULT_TIMEOUT;
+    else              timeout = engine_timeout_secs(timeout);
+    e->hard_limit = timeout - LATENCY_MARGIN - timeout * LATENCY_RATIO;
+    if (e->hard_limit < timeout * 0.5) e->hard_limit = timeout * 0.5;
+    e->soft_limit = e->hard_limit * soft_frac;
+    atomic_store(&e->stop, 0);
+}
+
+/* 마감 없는 탐색(pondering, 고정 깊이): 중단 플래그로만 멈춘다 */
+static void time_init_unlimited(Engine *e)
+{
+    clock_gettime(CLOCK_MONOTONIC, &e->start_time);
+    e->soft_limit = e->hard_limit = HUGE_VAL;
+    atomic_store(&e->stop, 0);
+}
+
+/* 중단 플래그만 확인 (시스템 콜 없음) */
+static inline int time_exceeded(Engine *e)
+{
+    return atomic_load_explicit(&e->stop, memory_order_relaxed);
+}
+
+/* hard 마감을 직접 확인하고 지났으면 모든 스레드를 멈춘다 */
+static int check_deadline(Engine *e)
+{
+    if (elapsed_time(e) >= e->hard_limit)
+        atomic_store_explicit(&e->stop, 1, memory_order_relaxed);
+    return time_exceeded(e);
+}
+
+/* =================================================================
+*                        AI  (Iterative Deepening + α-β 가지치기)
+*
+*  Lazy SMP: 모든 스레드가 같은 루트를 각자 반복 심화로 탐색하고
+*  치환표만 공유한다.  보조 스레드는 홀수 번호마다 한 단계 깊게 시작해
+*  서로 다른 깊이를 채워 주고, 결과는 가장 깊게 끝낸 스레드 것을 쓴다.
+* =================================================================*/
+
+/* 수 정렬 점수: 치환표 수 > 킬러 > (말 수 변화, history) */
+#define HIST_MAX      16384
+#define GAIN_WEIGHT   (2 * HIST_MAX + 1)
+#define ORDER_KILLER  (1 << 29)
+#define ORDER_TT      (1 << 30)
+
+#define ASP_WINDOW    50        /* 애스피레이션 창 반폭 (말 하나 = 100) */
+#define ASP_MIN_DEPTH 3         /* 이 깊이부터 애스피레이션 사용 */
+
+/* 선택적 탐색.  평가값이 깊이의 홀짝에 따라 크게 흔들리므로(마지막에 둔
+   쪽이 유리) 줄이는 양은 항상 2의 배수로 해서 말단의 홀짝을 유지한다. */
+#define LMR_MIN_DEPTH      3    /* 이 깊이부터 늦은 수를 줄인다 */
+#define LMR_FULL_MOVES     3    /* 앞의 이만큼은 줄이지 않는다 */
+#define LMR_LATE_MOVES     12   /* 이보다 뒤면 더 줄인다 */
+#define PROBCUT_MIN_DEPTH  6
+#define PROBCUT_REDUCTION  4    /* 얕은 탐색 깊이 = depth - 이것 */
+#define PROBCUT_MARGIN     150  /* 얕은 탐색 값이 창 밖으로 이만큼 나가면 자른다 */
+
+/* 정지 탐색: 말단에서 크게 뒤집는 수만 조금 더 읽는다 */
+#define QS_MIN_FLIPS       5    /* 이만큼 이상 뒤집는 수만 */
+#define QS_MAX_PLY         4    /* 말단에서 더 읽는 최대 수 */
+#define QS_DELTA           50   /* delta pruning 여유 (말 하나 = 100) */
+
+struct Worker {
+    pthread_t tid;
+    int       id;
+    Engine   *eng;
+    Pos       pos;                  /* 이 스레드가 make/unmake 하는 보드 */
+    int       side;                 /* 루트에서 둘 차례 */
+    Undo      undo_stack[MAX_PLY];  /* ply별 되돌리기 스택 */
+    uint16_t  killers[MAX_PLY][2];  /* ply별 β-컷 낸 수 2개 */
+    int32_t   history[2][NSQ][NSQ]; /* [side][from][to] β-컷 이력 */
+    uint16_t  pv[MAX_PLY][MAX_PLY]; /* 삼각 PV 테이블 (move_id) */
+    int       pv_len[MAX_PLY];
+    uint16_t  best_pv[MAX_PLY];     /* 마지막으로 끝낸 반복의 PV */
+    int       best_pv_len;
+    Move      root_moves[MAX_MOVES];/* 반복 간 유지, 직전 반복 결과 순 */
+    int       root_cnt;
+    int       iter_best;            /* 이번 반복에서 α를 넘긴 마지막 루트 수 */
+    int       best_move;            /* 마지막으로 끝낸 깊이의 최선 수 */
+    int       best_score;
+    int       best_depth;
+    uint64_t  nodes;
+    uint64_t  rng;                  /* MCTS playout 난수 상태 */
+    int       eg_cut;               /* 종반 solver: 이번 패스가 점프 한도에 걸렸음 */
+    int       eg_loser;             /* 종반 solver: 한도에서 불리하게 자르는 색 */
+    SearchStats stats;
+    IterInfo  iters[MAX_PLY];
+    int       iter_cnt;
+    NNAccum   acc[MAX_PLY + 1];     /* ply별 신경망 누산기 (eng->nn 일 때만) */
+};
+
+/* 탐색 트리 안의 make_move: 신경망 평가면 누산기도 acc[ply] → acc[ply+1]
+   로 바뀐 칸만큼 갱신한다.  되돌릴 때는 acc[ply] 가 그대로 남아 있다. */
+static inline void search_make(Worker *w, int side, int ply, const Move *m, Undo *u)
+{
+    make_move(&w->pos, side, m->from, m->to, u);
+    if (w->eng->nn)
+        nn_update(w->eng->nn, &w->acc[ply], &w->acc[ply + 1], side, m->to, u);
+}
+
+static inline int search_eval(const Worker *w, int side, int ply)
+{
+    return w->eng->nn ? nn_output(w->eng->nn, &w->acc[ply], side)
+                      : evaluate_board(&w->pos, side);
+}
+
+/* 치환표·킬러·history 에 쓰는 수 식별자.
+   복제는 결과가 출발 칸과 무관하므로 from = to 로 통일한다. */
+static inline int move_id(const Move *m)
+{
+    return (ADJ[m->from] & BB_SQ(m->to)) ? PACK_MOVE(m->to, m->to)
+                                         : PACK_MOVE(m->from, m->to);
+}
+
+static void score_moves(const Worker *w, const Pos *p, int side, int ply,
+                        Move *mv, int n, int tt_move)
+{
+    bb_t opp = p->bb[side ^ 1];
+    for (int i = 0; i < n; ++i) {
+        int id = move_id(&mv[i]);
+        if      (id == tt_move)              mv[i].score = ORDER_TT;
+        else if (id == w->killers[ply][0])   mv[i].score = ORDER_KILLER + 1;
+        else if (id == w->killers[ply][1])   mv[i].score = ORDER_KILLER;
+        else {
+            // 말 수 차이 변화: 뒤집을 때마다 +2, 복제면 +1
+            int gain = 2 * bb_count(ADJ[mv[i].to] & opp)
+                     + (MOVE_FROM(id) == MOVE_TO(id));
+            mv[i].score = gain * GAIN_WEIGHT
+                        + w->history[side][MOVE_FROM(id)][MOVE_TO(id)];
+        }
+    }
+}
+
+/* i 번째 이후에서 점수가 가장 높은 수를 i 자리로 (전체 정렬 대신) */
+static inline void pick_move(Move *mv, int n, int i)
+{
+    int best = i;
+    for (int j = i + 1; j < n; ++j)
+        if (mv[j].score > mv[best].score) best = j;
+    Move tmp = mv[i];
+    mv[i] = mv[best];
+    mv[best] = tmp;
+}
+
+static inline void history_update(int32_t *h, int bonus)
+{
+    *h += bonus - *h * abs(bonus) / HIST_MAX;
+}
+
+/* β-컷: 킬러 등록, 컷 낸 수는 history 가산, 앞서 실패한 수는 감산 */
+static void update_ordering(Worker *w, int side, int ply, int depth,
+                            const Move *mv, int cut)
+{
+    int id = move_id(&mv[cut]);
+    if (w->killers[ply][0] != id) {
+        w->killers[ply][1] = w->killers[ply][0];
+        w->killers[ply][0] = (uint16_t)id;
+    }
+    int bonus = depth * depth;
+    history_update(&w->history[side][MOVE_FROM(id)][MOVE_TO(id)], bonus);
+    for (int i = 0; i < cut; ++i) {
+        int f = move_id(&mv[i]);
+        history_update(&w->history[side][MOVE_FROM(f)][MOVE_TO(f)], -bonus);
+    }
+}
+
+/* i 번째 수(0부터)를 얼마나 줄일지: 늦을수록 더, 컷을 자주 낸 수(history)는 덜 */
+static inline int lmr_reduction(const Worker *w, int side, int depth, int i, const Move *m)
+{
+    if (depth < LMR_MIN_DEPTH || i < LMR_FULL_MOVES || m->score >= ORDER_KILLER)
+        return 0;
+    int id = move_id(m);
+    int h = w->history[side][MOVE_FROM(id)][MOVE_TO(id)];
+    int r = (i >= LMR_LATE_MOVES && depth >= 2 * LMR_MIN_DEPTH) ? 4 : 2;
+    if (h > HIST_MAX / 2)       r -= 2;
+    else if (h < -HIST_MAX / 2) r += 2;
+    while (r > 0 && depth - 1 - r < 1) r -= 2;
+    return r;
+}
+
+/* ply 의 PV 를 move + (ply+1 의 PV) 로 갱신 */
+static inline void update_pv(Worker *w, int ply, int move)
+{
+    w->pv[ply][ply] = (uint16_t)move;
+    int len = w->pv_len[ply + 1];
+    for (int k = ply + 1; k < len; ++k)
+        w->pv[ply][k] = w->pv[ply + 1][k];
+    w->pv_len[ply] = len > ply + 1 ? len : ply + 1;
+}
+
+/* 정적 평가 내림차순 정렬 (루트 전용) */
+static void sort_moves(Move *mv, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            if (mv[j].score > mv[i].score) {
+                Move tmp = mv[i];
+                mv[i] = mv[j];
+                mv[j] = tmp;
+            }
+        }
+    }
+}
+
+/* ====================
+정지 탐색 (Quiescence): depth 0 에서 평가값이 크게 흔들리는 국면만 연장.
+QS_MIN_FLIPS 개 이상 뒤집는 수(목표 칸당 하나, 복제 우선)만 보고,
+stand-pat(그냥 평가값)을 하한으로 삼는다.  말 수 변화를 다 더해도 α에
+못 미치는 수는 읽지 않는다 (delta pruning).
+==================== */
+static int quiesce(Worker *w, int side, int ply, int qply, int alpha, int beta)
+{
+    Engine *e = w->eng;
+    Pos *p = &w->pos;
+    if ((++w->nodes & (TIME_CHECK_NODES - 1)) == 0) check_deadline(e);
+    STAT(w, qnodes);
+    w->pv_len[ply] = ply;
+
+    int stand = search_eval(w, side, ply);
+    if (stand >= beta || qply >= QS_MAX_PLY || ply >= MAX_PLY - 1 || time_exceeded(e))
+        return stand;
+    if (stand > alpha) alpha = stand;
+
+    // 후보: 내 말이 닿는 빈칸 중 주변 상대 말이 QS_MIN_FLIPS 개 이상인 칸
+    bb_t own = p->bb[side], opp = p->bb[side ^ 1];
+    bb_t clone = bb_adjacent(own);
+    bb_t tgt = (clone | bb_jumps(own)) & empty_bb(p) & bb_adjacent(opp);
+    Move mv[NSQ];
+    int n = 0;
+    while (tgt) {
+        int to = bb_pop(&tgt);
+        int flips = bb_count(ADJ[to] & opp);
+        if (flips < QS_MIN_FLIPS) continue;
+        int is_clone = (clone & BB_SQ(to)) != 0;
+        int gain = 2 * flips + is_clone;            // 말 수 차이 변화
+        if (stand + gain * 100 + QS_DELTA <= alpha) continue;
+        int from = bb_lsb(is_clone ? ADJ[to] & own : JUMP[to] & own);
+        mv[n++] = (Move){ from, to, gain };
+    }
+
+    Undo *u = &w->undo_stack[ply];
+    int best = stand;
+    for (int i = 0; i < n; ++i) {
+        pick_move(mv, n, i);
+        search_make(w, side, ply, &mv[i], u);
+        int v = -quiesce(w, side ^ 1, ply + 1, qply + 1, -beta, -alpha);
+        unmake_move(p, side, u);
+        if (v > best) best = v;
+        if (v > alpha) alpha = v;
+        if (alpha >= beta || time_exceeded(e)) break;
+    }
+    return best;
+}
+
+/* ====================
+α-β 가지치기 탐색 (negamax 형태, 점수는 side 관점)
+==================== */
+static int alpha_beta(Worker *w, int side, int ply,
+                    int depth, int alpha, int beta)
+{
+    if (depth <= 0) return quiesce(w, side, ply, 0, alpha, beta);
+
+    Engine *e = w->eng;
+    Pos *p = &w->pos;
+    if ((++w->nodes & (TIME_CHECK_NODES - 1)) == 0) check_deadline(e);
+    w->pv_len[ply] = ply;
+
+    if (time_exceeded(e)) {
+        return search_eval(w, side, ply);
+    }
+
+    // 한쪽 말이 모두 없어지면 서버는 그 자리에서 게임을 끝낸다 (패스가 아님)
+    if (!p->bb[side] || !p->bb[side ^ 1])
+        return p->bb[side] ? INF/2 : -INF/2;
+
+    // 치환표 조회: 충분히 깊은 결과면 바로 반환, 아니면 최선 수만 가져옴
+    uint64_t key = p->key ^ ZOB_SIDE[side];
+    int tt_move = MOVE_NONE;
+    TTHit te;
+    STAT(w, tt_probes);
+    if (tt_probe(&e->tt, key, &te)) {
+        STAT(w, tt_hits);
+        tt_move = te.move;
+        if (te.depth >= depth) {
+            if (te.bound == TT_EXACT
+                || (te.bound == TT_LOWER && te.score >= beta)
+                || (te.bound == TT_UPPER && te.score <= alpha)) {
+                STAT(w, tt_cutoffs);
+                return te.score;
+            }
+        }
+    }
+
+    // 만약 현재 플레이어가 둘 수 없으면(턴 건너뛰기 검사)
+    if (!has_moves(p, side)) {
+        if (!has_moves(p, side ^ 1)) {
+            // 양쪽 모두 못 두면 게임 종료, 터미널 스코어
+            int diff = bb_count(p->bb[side]) - bb_count(p->bb[side ^ 1]);
+            if      (diff > 0) return  INF/2;
+            else if (diff < 0) return -INF/2;
+            else               return  0;
+        }
+        // 상대만 수가 있으면, 내 차례 건너뛰기.  패스도 깊이를 하나 쓴다:
+        // 갇힌 쪽이 계속 패스하면 한쪽만 연달아 두는 트리라 α-β 가 자르지 못한다
+        return -alpha_beta(w, side ^ 1, ply + 1, depth - 1, -beta, -alpha);
+    }
+
+    // ProbCut: null window 노드에서 얕게 읽은 값이 창 밖으로 PROBCUT_MARGIN
+    // 넘게 벗어나면 깊게 읽어도 그쪽이라고 보고 자른다
+    if (depth >= PROBCUT_MIN_DEPTH && beta - alpha == 1
+        && beta < INF / 4 && alpha > -INF / 4) {
+        int rbeta = beta + PROBCUT_MARGIN;
+        int v = alpha_beta(w, side, ply, depth - PROBCUT_REDUCTION, rbeta - 1, rbeta);
+        if (v >= rbeta && !time_exceeded(e)) {
+            STAT(w, probcuts);
+            return beta;
+        }
+        int ralpha = alpha - PROBCUT_MARGIN;
+        v = alpha_beta(w, side, ply, depth - PROBCUT_REDUCTION, ralpha, ralpha + 1);
+        if (v <= ralpha && !time_exceeded(e)) {
+            STAT(w, probcuts);
+            return alpha;
+        }
+    }
+
+    // (1) 가능한 모든 수 생성 & 정렬 점수 (평가 함수 호출 없음)
+    Undo *u = &w->undo_stack[ply];
+    Move all_moves[MAX_MOVES];
+    int move_cnt = gen_moves(p, side, all_moves);
+    score_moves(w, p, side, ply, all_moves, move_cnt, tt_move);
+    STAT(w, interior);
+
+    // (2) PVS: 매번 남은 수 중 최고 점수를 골라, 첫 수만 전체 창으로,
+    //     나머지는 null window 로 보고 α를 넘을 때만 다시 탐색.
+    //     늦은 수는 줄인 깊이로 먼저 보고, α를 넘으면 원래 깊이로 확인한다
+    int alpha_orig = alpha;
+    int best_val = -INF, best_move = MOVE_NONE;
+    for (int i = 0; i < move_cnt; ++i) {
+        pick_move(all_moves, move_cnt, i);
+        search_make(w, side, ply, &all_moves[i], u);
+        STAT(w, children);
+        int val;
+        if (i == 0) {
+            val = -alpha_beta(w, side ^ 1, ply + 1, depth - 1, -beta, -alpha);
+        } else {
+            int r = lmr_reduction(w, side, depth, i, &all_moves[i]);
+            val = -alpha_beta(w, side ^ 1, ply + 1, depth - 1 - r, -alpha - 1, -alpha);
+            if (r > 0) {
+                STAT(w, reductions);
+                if (val > alpha) {
+                    STAT(w, researches);
+                    val = -alpha_beta(w, side ^ 1, ply + 1, depth - 1, -alpha - 1, -alpha);
+                }
+            }
+            if (val > alpha && val < beta)
+                val = -alpha_beta(w, side ^ 1, ply + 1, depth - 1, -beta, -alpha);
+        }
+        unmake_move(p, side, u);
+        if (val > best_val) {
+            best_val = val;
+            best_move = move_id(&all_moves[i]);
+        }
+        if (best_val > alpha) {
+            alpha = best_val;
+            update_pv(w, ply, best_move);
+        }
+        if (alpha >= beta) {
+            STAT(w, cutoffs);
+            if (i == 0) STAT(w, first_cutoffs);
+            update_ordering(w, side, ply, depth, all_moves, i);
+            break;
+        }
+        if (time_exceeded(e)) break;
+    }
+
+    // 시간 초과로 중단된 결과는 저장하지 않는다
+    if (!time_exceeded(e)) {
+        int bound = best_val <= alpha_orig ? TT_UPPER
+                  : best_val >= beta       ? TT_LOWER : TT_EXACT;
+        tt_store(&e->tt, key, depth, best_val, bound, best_move);
+    }
+    return best_val;
+}
+
+/* 루트 탐색: 직전 반복 순서대로 PVS. α를 넘긴 수는 iter_best 로 기록해
+   반복이 중간에 끊겨도 끝까지 검증된 수만 쓸 수 있게 한다. */
+static int search_root(Worker *w, int depth, int alpha, int beta)
+{
+    Pos *p = &w->pos;
+    int side = w->side;
+    int best = -INF;
+    w->pv_len[0] = 0;
+
+    for (int i = 0; i < w->root_cnt; ++i) {
+        Move *m = &w->root_moves[i];
+        search_make(w, side, 0, m, &w->undo_stack[0]);
+        int score;
+        if (i == 0) {
+            score = -alpha_beta(w, side ^ 1, 1, depth - 1, -beta, -alpha);
+        } else {
+            score = -alpha_beta(w, side ^ 1, 1, depth - 1, -alpha - 1, -alpha);
+            if (score > alpha && score < beta)
+                score = -alpha_beta(w, side ^ 1, 1, depth - 1, -beta, -alpha);
+        }
+        unmake_move(p, side, &w->undo_stack[0]);
+        if (time_exceeded(w->eng)) break;   // 끊긴 탐색의 점수는 버린다
+
+        m->score = score;
+        if (score > best) best = score;
+        if (score > alpha) {
+            alpha = score;
+            w->iter_best = i;
+            update_pv(w, 0, move_id(m));
+        }
+        if (alpha >= beta) break;
+    }
+    return best;
+}
+
+/* 다음 반복을 위해 루트 수 재정렬: 이번 최선 수를 맨 앞, 나머지는 점수 순 */
+static void reorder_root(Worker *w)
+{
+    if (w->iter_best > 0) {
+        Move tmp = w->root_moves[w->iter_best];
+        memmove(&w->root_moves[1], &w->root_moves[0], w->iter_best * sizeof(Move));
+        w->root_moves[0] = tmp;
+    }
+    // 나머지는 안정 삽입 정렬 (대부분 이미 정렬돼 있음)
+    for (int i = 2; i < w->root_cnt; ++i) {
+        Move m = w->root_moves[i];
+        int j = i;
+        while (j > 1 && w->root_moves[j - 1].score < m.score) {
+            w->root_moves[j] = w->root_moves[j - 1];
+            --j;
+        }
+        w->root_moves[j] = m;
+    }
+}
+
+/* 한 스레드의 반복 심화 루프 */
+static void *search_worker(void *arg)
+{
+    Worker *w = arg;
+    Engine *e = w->eng;
+    int stable = 0;
+
+    // 시간 내에 가능한 만큼 깊이(depth)를 1씩 늘리며 탐색
+    for (int depth = 1 + (w->id & 1);
+         depth <= e->cfg.max_depth && depth < MAX_PLY; ++depth) {
+        if (check_deadline(e)) break;
+
+        // 직전 점수를 중심으로 한 애스피레이션 창, 벗어나면 넓혀서 재탐색
+        int delta = ASP_WINDOW;
+        int alpha = -INF, beta = INF;
+        if (depth >= ASP_MIN_DEPTH && w->best_depth > 0) {
+            alpha = w->best_score - delta;
+            beta  = w->best_score + delta;
+        }
+        w->iter_best = -1;
+        int score;
+        for (;;) {
+            score = search_root(w, depth, alpha, beta);
+            if (time_exceeded(e)) break;
+            if (score <= alpha && alpha > -INF)
+                alpha = (alpha - delta < -INF / 2) ? -INF : alpha - delta;
+            else if (score >= beta && beta < INF)
+                beta  = (beta + delta > INF / 2)   ?  INF : beta + delta;
+            else break;
+            delta *= 2;
+        }
+
+        // 끊긴 반복이라도 α를 넘겨 끝까지 검증된 수가 있으면 그 수로 바꾼다
+        if (w->iter_best >= 0) {
+            Move *m = &w->root_moves[w->iter_best];
+            w->best_move = PACK_MOVE(m->from, m->to);
+        }
+        if (time_exceeded(e) || w->iter_best < 0) break;
+
+        // 이 깊이 탐색을 완료했다면, 최고 결과를 “전체 최적”으로 갱신
+        int move = PACK_MOVE(w->root_moves[w->iter_best].from,
+                             w->root_moves[w->iter_best].to);
+        stable = (move == PACK_MOVE(w->root_moves[0].from,
+                                    w->root_moves[0].to)) ? stable + 1 : 0;
+        w->best_score = score;
+        w->best_depth = depth;
+        if (w->iter_cnt < MAX_PLY) {
+            IterInfo *it = &w->iters[w->iter_cnt++];
+            *it = (IterInfo){ depth, score, move, elapsed_time(e), w->nodes, { 0 } };
+#ifdef OCTAFLIP_STATS
+            it->stats = w->stats;
+            it->stats.nodes = w->nodes;
+#endif
+        }
+        w->best_pv_len = w->pv_len[0];
+        memcpy(w->best_pv, w->pv[0], w->pv_len[0] * sizeof(uint16_t));
+        reorder_root(w);
+
+        // 시간 배분은 주 스레드가 정한다: soft 마감이 지났거나,
+        // 최선 수가 STABLE_ITERS 번 연속 그대로고 soft 의 절반을 넘겼으면 끝
+        if (w->id == 0) {
+            double t = elapsed_time(e);
+            if (t >= e->soft_limit) break;
+            if (stable >= STABLE_ITERS && t >= e->soft_limit * 0.5) break;
+        }
+    }
+
+    // 주 스레드가 끝나면(최대 깊이 도달 포함) 보조 스레드도 멈춘다
+    if (w->id == 0) atomic_store(&e->stop, 1);
+    return NULL;
+}
+
+/* =================================================================
+*                  종반 완전 탐색 (Endgame solver)
+*
+*  빈칸이 endgame_empties 개 이하이면 평가 함수 대신 게임 끝까지 읽어
+*  최종 말 수 차이를 구한다.  단, 점프는 빈칸을 줄이지 않아 수순이
+*  끝없이 길어질 수 있으므로 한 수순의 점프는 jumps 번까지만 읽는다.
+*  한도가 다 된 노드 (eg_cut) 에서 점프를 그냥 빼면 그 값은 실제 게임
+*  값의 상한도 하한도 아니므로, 한 패스는 한쪽 색 (eg_loser) 을 정해
+*  그쪽에 불리하게만 자른다:
+*    - eg_loser 차례: 점프를 빼고 복제만 (고를 수가 줄어 손해만 본다),
+*      복제할 곳도 없으면 -NSQ
+*    - 상대 차례: 그 자리에서 상대가 +NSQ 로 이긴 것으로 친다
+*  그래서 패스 값은 eg_loser 쪽에서 본 실제 값의 하한이다.  루트 쪽을
+*  eg_loser 로 한 패스 (하한) 와 상대를 eg_loser 로 한 패스 (상한) 가
+*  같은 결론을 내면 증명이고, 아니면 한도를 EG_JUMPS 씩 늘려 다시 한다
+*  (EG_JUMPS_MAX 까지, 시간 안에서).  이기는 쪽은 점프를 안 해도 보통
+*  빈칸을 다 채워 끝내므로, 한도는 지는 쪽이 점프로 버티는 수만큼이면 된다.
+*
+*  루트는 먼저 (-1, 1) 창으로 승/무/패를 증명하고, 시간이 남으면
+*  null window PVS 로 최선 수의 말 수 차이를 정확히 구한다.
+*  치환표는 일반 탐색과 따로 쓴다 (값의 단위와 의미가 다르므로).
+* =================================================================*/
+#define EG_JUMPS           2        /* 첫 패스의 수순당 점프 수, 패스마다 이만큼 늘림 */
+#define EG_JUMPS_MAX       24
+#define EG_HASH_BITS       18
+#define EG_TIME_FRAC       0.6      /* hard 마감 중 solver 에 주는 비율 */
+
+/* 값은 점프 한도와 eg_loser 에 따라 다르므로 둘 다 key 에 넣는다 */
+static inline uint64_t eg_key(const Pos *p, int side, int jumps, int loser)
+{
+    return p->key ^ ZOB_SIDE[side]
+         ^ ((uint64_t)(2 * jumps + loser + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+/* 종반 수 생성: 점프 한도가 남았을 때만 점프 포함 */
+static int eg_gen_moves(const Pos *p, int side, int jumps, Move *mv, int tt_move)
+{
+    bb_t own = p->bb[side], opp = p->bb[side ^ 1], empty = empty_bb(p);
+    int n = 0;
+    for (bb_t clone = bb_adjacent(own) & empty; clone; ) {
+        int to = bb_pop(&clone);
+        int gain = 2 * bb_count(ADJ[to] & opp) + 1;
+        mv[n++] = (Move){ bb_lsb(ADJ[to] & own), to, gain };
+    }
+    if (jumps > 0) {
+        for (bb_t src = own; src; ) {
+            int from = bb_pop(&src);
+            for (bb_t tgt = JUMP[from] & empty; tgt; ) {
+                int to = bb_pop(&tgt);
+                mv[n++] = (Move){ from, to, 2 * bb_count(ADJ[to] & opp) };
+            }
+        }
+    }
+    for (int i = 0; i < n; ++i)
+        if (move_id(&mv[i]) == tt_move) mv[i].score = ORDER_TT;
+    return n;
+}
+
+/* 최종 말 수 차이 (side 관점) 를 구하는 fail-soft α-β.
+   점프 한도가 다 되면 w->eg_loser 쪽에 불리하게 자른다 (위 설명) */
+static int eg_solve(Worker *w, int side, int ply, int jumps, int alpha, int beta)
+{
+    Engine *e = w->eng;
+    Pos *p = &w->pos;
+    if ((++w->nodes & (TIME_CHECK_NODES - 1)) == 0) check_deadline(e);
+    if (time_exceeded(e)) return 0;
+
+    bb_t own = p->bb[side], opp = p->bb[side ^ 1], empty = empty_bb(p);
+    int diff = bb_count(own) - bb_count(opp);
+    if (!own || !opp) return diff;                  // 전멸하면 게임 끝
+    bb_t clones = bb_adjacent(own) & empty;
+    bb_t jumpable = bb_jumps(own) & empty;
+    if (!clones && !jumpable) {
+        // 둘 곳 없음: 상대도 없으면 게임 끝, 아니면 패스
+        if (!((bb_adjacent(opp) | bb_jumps(opp)) & empty)) return diff;
+        return -eg_solve(w, side ^ 1, ply, jumps, -beta, -alpha);
+    }
+    // 점프 한도 소진: eg_loser 는 복제만, 상대는 이긴 것으로
+    if (jumps == 0 && jumpable) {
+        w->eg_cut = 1;
+        if (side != w->eg_loser) return NSQ;
+        if (!clones) return -NSQ;
+    }
+
+    uint64_t key = eg_key(p, side, jumps, w->eg_loser);
+    EGEntry *ent = &e->eg_hash[key & ((1 << EG_HASH_BITS) - 1)];
+    int tt_move = MOVE_NONE;
+    if (ent->key == key) {
+        if (ent->lower >= beta)  return ent->lower;
+        if (ent->upper <= alpha) return ent->upper;
+        if (ent->lower > alpha) alpha = ent->lower;
+        if (ent->upper < beta)  beta  = ent->upper;
+        tt_move = ent->move;
+    }
+
+    Undo *u = &w->undo_stack[ply];
+    Move mv[MAX_MOVES];
+    int n = eg_gen_moves(p, side, jumps, mv, tt_move);
+    int alpha_orig = alpha;
+    int best = -INF, best_move = MOVE_NONE;
+    for (int i = 0; i < n; ++i) {
+        pick_move(mv, n, i);
+        int jump = !(ADJ[mv[i].from] & BB_SQ(mv[i].to));
+        make_move(p, side, mv[i].from, mv[i].to, u);
+        int v;
+        if (i == 0) {
+            v = -eg_solve(w, side ^ 1, ply + 1, jumps - jump, -beta, -alpha);
+        } else {
+            v = -eg_solve(w, side ^ 1, ply + 1, jumps - jump, -alpha - 1, -alpha);
+            if (v > alpha && v < beta)
+                v = -eg_solve(w, side ^ 1, ply + 1, jumps - jump, -beta, -alpha);
+        }
+        unmake_move(p, side, u);
+        if (time_exceeded(e)) return 0;
+        if (v > best) { best = v; best_move = move_id(&mv[i]); }
+        if (v > alpha) alpha = v;
+        if (alpha >= beta) break;
+    }
+
+    ent->key   = key;
+    ent->lower = (int8_t)(best > alpha_orig ? best : -NSQ);
+    ent->upper = (int8_t)(best < beta ? best : NSQ);
+    ent->move  = (uint16_t)best_move;
+    return best;
+}
+
+/* 루트 한 번 훑기: 점프 한도 jumps, loser 쪽에 불리하게 자른 [alpha, beta]
+   창의 PVS.  끝까지 검증된 최선 수를 *best_idx 에 (시간이 다 돼도 그때까지 것) */
+static int eg_root(Worker *w, int jumps, int loser, int alpha, int beta, int *best_idx)
+{
+    Pos *p = &w->pos;
+    int side = w->side;
+    int best = -INF;
+    w->eg_loser = loser;
+    w->eg_cut = 0;
+    for (int i = 0; i < w->root_cnt; ++i) {
+        Move *m = &w->root_moves[i];
+        int left = jumps - !(ADJ[m->from] & BB_SQ(m->to));
+        make_move(p, side, m->from, m->to, &w->undo_stack[0]);
+        int v;
+        if (i == 0) {
+            v = -eg_solve(w, side ^ 1, 1, left, -beta, -alpha);
+        } else {
+            v = -eg_solve(w, side ^ 1, 1, left, -alpha - 1, -alpha);
+            if (v > alpha && v < beta)
+                v = -eg_solve(w, side ^ 1, 1, left, -beta, -alpha);
+        }
+        unmake_move(p, side, &w->undo_stack[0]);
+        if (time_exceeded(w->eng)) break;
+        if (v > best) best = v;
+        if (v > alpha) { alpha = v; *best_idx = i; }
+        if (alpha >= beta) break;
+    }
+    return best;
+}
+
+/* 승/무/패를 증명하면 1 (최선 수와 말 수 차이 반환), 시간이나 점프 한도
+   안에 못 하면 0.  0 이어도 무 이상이 증명된 수가 있으면 *best_move 는
+   그 수 (아니면 MOVE_NONE) */
+static int endgame_solve(Worker *w, int *best_move, int *score, int *exact)
+{
+    *best_move = MOVE_NONE;
+    if (w->root_cnt == 0) return 0;
+    int me = w->side;
+
+    // (1) 승/무/패: (-1, 1) 창의 하한 패스 (내가 loser) 와 상한 패스 (상대가 loser).
+    //     어느 패스도 한도에 걸리지 않았으면 그 한도에서 더 늘려도 같다
+    int jumps, idx = -1, wld = 0, proven = 0;
+    for (jumps = EG_JUMPS; jumps <= EG_JUMPS_MAX; jumps += EG_JUMPS) {
+        int lo_idx = -1, hi_idx = -1;
+        int lo = eg_root(w, jumps, me, -1, 1, &lo_idx);
+        int cut = w->eg_cut;
+        if (time_exceeded(w->eng)) break;
+        if (lo_idx >= 0) idx = lo_idx;              // 무 이상이 증명된 수
+        if (lo >= 1) { wld = lo; proven = 1; break; }
+        int hi = eg_root(w, jumps, me ^ 1, -1, 1, &hi_idx);
+        cut |= w->eg_cut;
+        if (time_exceeded(w->eng)) break;
+        if (hi <= -1) {
+            wld = hi; proven = 1;
+            if (idx < 0) idx = hi_idx >= 0 ? hi_idx : 0;
+            break;
+        }
+        if (lo >= 0 && hi <= 0) { wld = 0; proven = 1; break; }
+        if (!cut) break;
+    }
+    if (idx >= 0)
+        *best_move = PACK_MOVE(w->root_moves[idx].from, w->root_moves[idx].to);
+    if (!proven) return 0;
+    *score = wld;
+    *exact = (wld == 0);
+    if (*exact) return 1;
+
+    // (2) 정확한 말 수 차이: 승이면 (0, NSQ], 패면 [-NSQ, 0) 안에서 최선 수를
+    //     먼저.  같은 한도의 하한·상한이 맞아떨어질 때만 정확한 값으로 친다
+    Move first = w->root_moves[idx];
+    memmove(&w->root_moves[1], &w->root_moves[0], idx * sizeof(Move));
+    w->root_moves[0] = first;
+    int lo = wld > 0 ? 0 : -NSQ - 1, hi = wld > 0 ? NSQ + 1 : 0;
+    int lo_idx = -1, hi_idx = -1;
+    int vlo = eg_root(w, jumps, me, lo, hi, &lo_idx);
+    if (time_exceeded(w->eng)) return 1;
+    int vhi = eg_root(w, jumps, me ^ 1, lo, hi, &hi_idx);
+    if (time_exceeded(w->eng) || vlo != vhi) return 1;
+    if (lo_idx >= 0)
+        *best_move = PACK_MOVE(w->root_moves[lo_idx].from, w->root_moves[lo_idx].to);
+    *score = vlo;
+    *exact = 1;
+    return 1;
+}
+
+/* =================================================================
+*                  탐색 준비·실행
+* =================================================================*/
+
+/* 모든 worker 를 root 에서 시작하도록 준비. 루트 후보는 정적 평가 순 */
+static void search_prepare(Engine *e, Pos *root, int side)
+{
+    // 루트 후보 생성 & 정적 평가 — 보드가 바뀌지 않으므로 한 번만
+    Move root_moves[MAX_MOVES];
+    int root_cnt = gen_moves(root, side, root_moves);
+    NNAccum acc[2];
+    if (e->nn) nn_refresh(e->nn, root, &acc[0]);
+    Undo u;
+    for (int i = 0; i < root_cnt; ++i) {
+        make_move(root, side, root_moves[i].from, root_moves[i].to, &u);
+        if (e->nn) {
+            nn_update(e->nn, &acc[0], &acc[1], side, root_moves[i].to, &u);
+            root_moves[i].score = nn_output(e->nn, &acc[1], side);
+        } else {
+            root_moves[i].score = evaluate_board(root, side);
+        }
+        unmake_move(root, side, &u);
+    }
+    sort_moves(root_moves, root_cnt);
+
+    for (int t = 0; t < e->cfg.threads; ++t) {
+        Worker *w = &e->workers[t];
+        w->id         = t;
+        w->eng        = e;
+        w->pos        = *root;
+        w->side       = side;
+        w->root_cnt   = root_cnt;
+        w->best_move  = MOVE_NONE;
+        w->best_score = 0;
+        w->best_depth = 0;
+        w->best_pv_len = 0;
+        w->nodes      = 0;
+        w->stats      = (SearchStats){ 0 };
+        w->iter_cnt   = 0;
+        for (int k = 0; k < MAX_PLY; ++k)
+            w->killers[k][0] = w->killers[k][1] = MOVE_NONE;
+        // 지난 턴의 history 는 절반만 남긴다
+        for (int c = 0; c < 2; ++c)
+            for (int f = 0; f < NSQ; ++f)
+                for (int to = 0; to < NSQ; ++to)
+                    w->history[c][f][to] /= 2;
+        memcpy(w->root_moves, root_moves, root_cnt * sizeof(Move));
+        if (e->nn) w->acc[0] = acc[0];
+    }
+}
+
+/* 바깥(캐시)에서 온 수를 모든 스레드의 루트 첫 후보로.  복제는 출발 칸이
+   달라도 같은 수이므로 도착 칸과 복제·점프만 맞춘다. */
+static void root_promote(Engine *e, int from, int to)
+{
+    int clone = (ADJ[from] & BB_SQ(to)) != 0;
+    for (int t = 0; t < e->cfg.threads; ++t) {
+        Worker *w = &e->workers[t];
+        for (int i = 0; i < w->root_cnt; ++i) {
+            Move m = w->root_moves[i];
+            if (m.to != to || ((ADJ[m.from] & BB_SQ(to)) != 0) != clone
+                || (!clone && m.from != from))
+                continue;
+            memmove(&w->root_moves[1], &w->root_moves[0], i * sizeof(Move));
+            w->root_moves[0] = m;
+            break;
+        }
+    }
+}
+
+/* 보조 스레드를 띄우고 주 스레드 탐색을 돌린 뒤 모두 합류. 실제로 돈 스레드 수 반환 */
+static int search_run(Engine *e)
+{
+    int started = 1;
+    for (int t = 1; t < e->cfg.threads; ++t, ++started)
+        if (pthread_create(&e->workers[t].tid, NULL, search_worker, &e->workers[t]) != 0)
+            break;
+    search_worker(&e->workers[0]);
+    for (int t = 1; t < started; ++t)
+        pthread_join(e->workers[t].tid, NULL);
+    return started;
+}
+
+static inline EngineMove to_engine_move(int move)
+{
+    if (move == MOVE_NONE) return (EngineMove){ -1, -1, -1, -1 };
+    return (EngineMove){ MOVE_FROM(move) / SIZE, MOVE_FROM(move) % SIZE,
+                         MOVE_TO(move) / SIZE,   MOVE_TO(move) % SIZE };
+}
+
+/* 주 스레드 PV 를 좌표로: 복제 출발 칸은 수순을 재현해서 고른다 */
+static void fill_pv(const Worker *w, EngineResult *res)
+{
+    Pos p = w->pos;
+    int side = w->side;
+    Undo u;
+    res->pv_len = 0;
+    for (int k = 0; k < w->best_pv_len; ++k) {
+        int id = w->best_pv[k];
+        int from = MOVE_FROM(id), to = MOVE_TO(id);
+        if (from == to) {
+            bb_t src = ADJ[to] & p.bb[side];
+            if (!src) { side ^= 1; src = ADJ[to] & p.bb[side]; }   // 패스였음
+            if (!src) break;
+            from = bb_lsb(src);
+        } else if (!(p.bb[side] & BB_SQ(from))) {
+            side ^= 1;
+            if (!(p.bb[side] & BB_SQ(from))) break;
+        }
+        res->pv[res->pv_len++] = to_engine_move(PACK_MOVE(from, to));
+        make_move(&p, side, from, to, &u);
+        side ^= 1;
+    }
+}
+
+/* =================================================================
+*                  MCTS (UCT, 트리 병렬)
+*
+*  EngineConfig.mcts 면 α-β 대신 쓴다.  모든 탐색 스레드가 트리 하나를
+*  함께 키운다 (tree parallelism).
+*   - 노드는 engine_create 때 hash_mb 만큼 잡아 둔 arena 에서 mcts_top 을
+*     fetch_add 해 떼어 쓴다.  한 노드의 자식은 연속 블록이고 해제는 없다
+*     (수마다 arena 를 비운다).
+*   - 펼치기는 lock 없이: state 를 LEAF→BUSY 로 CAS 한 스레드만 자식을
+*     만들고 child/nchild 를 쓴 뒤 OPEN 을 release 로 공개한다.  그동안
+*     다른 스레드는 그 노드에서 바로 playout 한다.
+*   - virtual loss: 내려가는 길의 노드에 방문을 MCTS_VLOSS 만큼 미리
+*     (진 것으로) 더해 두어 다른 스레드가 다른 가지를 고르게 하고,
+*     역전파 때 실제 결과 한 번으로 바꾼다.
+*   - playout: 갈 수 있는 빈칸 둘을 무작위로 뽑아 더 많이 뒤집는 쪽에
+*     둔다 (같은 칸이면 복제).  끝까지 두지 않고 MCTS_PLAYOUT_PLIES 수
+*     뒤의 말 수로 승 2 / 무 1 / 패 0 (0.2 초 대국에서 끝까지 두는 것보다
+*     +300 Elo).  짝수 수라 마지막에 둔 쪽으로 치우치지 않는다.
+*  나무 깊이 = 결과의 depth, playout 수 = nodes, 최다 방문 수를 둔다.
+* =================================================================*/
+#define MCTS_C              0.7     /* UCT 탐험 상수 */
+#define MCTS_VLOSS          3       /* virtual loss (방문 수) */
+#define MCTS_EXPAND         4       /* 이만큼 방문한 잎을 펼친다 */
+#define MCTS_PLAYOUT_PLIES  4       /* playout 길이 (짝수) */
+#define MCTS_CHECK          64      /* 시계 확인 주기 (playout, 2의 거듭제곱) */
+
+static inline uint64_t mcts_rand(uint64_t *s)
+{
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 0x2545F4914F6CDD1DULL;
+}
+
+/* b 의 k 번째(0부터) 말 */
+static inline int bb_nth(bb_t b, int k)
+{
+    while (k-- > 0) b &= b - 1;
+    return bb_lsb(b);
+}
+
+/* p 에서 side 차례로 MCTS_PLAYOUT_PLIES 수 (또는 끝까지) 둔 결과, RED 기준 승 2 / 무 1 / 패 0 */
+static int mcts_playout(Pos *p, int side, uint64_t *rng)
+{
+    for (int ply = 0; ply < MCTS_PLAYOUT_PLIES; ++ply) {
+        bb_t own = p->bb[side], opp = p->bb[side ^ 1], empty = empty_bb(p);
+        if (!own || !opp) break;
+        bb_t clone = bb_adjacent(own) & empty;
+        bb_t tgt = clone | (bb_jumps(own) & empty);
+        if (!tgt) {
+            if (!((bb_adjacent(opp) | bb_jumps(opp)) & empty)) break;
+            side ^= 1;                              // 패스
+            continue;
+        }
+        int n = bb_count(tgt), to = -1, best = -1;
+        for (int k = 0; k < 2; ++k) {
+            int sq = bb_nth(tgt, (int)(mcts_rand(rng) % n));
+            int gain = 2 * bb_count(ADJ[sq] & opp) + ((clone & BB_SQ(sq)) != 0);
+            if (gain > best) { best = gain; to = sq; }
+        }
+        bb_t flips = ADJ[to] & opp;
+        p->bb[side]     |= BB_SQ(to) | flips;
+        p->bb[side ^ 1] ^= flips;
+        if (!(clone & BB_SQ(to)))
+            p->bb[side] ^= BB_SQ(bb_lsb(JUMP[to] & own));
+        side ^= 1;
+    }
+    int diff = bb_count(p->bb[RED]) - bb_count(p->bb[BLUE]);
+    return diff > 0 ? 2 : diff < 0 ? 0 : 1;
+}
+
+/* 잎 n 을 펼친다 (n->state 를 BUSY 로 잡은 스레드만).  arena 가 차면 잎으로 남긴다 */
+static void mcts_expand(Engine *e, MNode *n, const Pos *p, int side)
+{
+    Move mv[MAX_MOVES];
+    int cnt = p->bb[side] && p->bb[side ^ 1] ? gen_moves(p, side, mv) : 0;
+    if (cnt == 0) {
+        if (!p->bb[side] || !p->bb[side ^ 1] || !has_moves(p, side ^ 1)) {
+            atomic_store_explicit(&n->state, MN_END, memory_order_release);
+            return;
+        }
+        mv[0] = (Move){ -1, -1, 0 };                // 패스 하나
+        cnt = 1;
+    } else {
+        bb_t own = p->bb[side], opp = p->bb[side ^ 1];
+        for (int i = 0; i < cnt; ++i)
+            mv[i].score = 2 * bb_count(ADJ[mv[i].to] & opp)
+                        + ((ADJ[mv[i].to] & own & BB_SQ(mv[i].from)) != 0);
+        sort_moves(mv, cnt);
+    }
+
+    uint32_t first = atomic_load_explicit(&e->mcts_top, memory_order_relaxed);
+    if (first + cnt <= e->mcts_cap)
+        first = atomic_fetch_add(&e->mcts_top, cnt);
+    if (first + cnt > e->mcts_cap) {
+        if (isinf(e->soft_limit)) atomic_store(&e->stop, 1);   // 마감 없는 탐색은 여기서 끝
+        atomic_store_explicit(&n->state, MN_LEAF, memory_order_release);
+        return;
+    }
+    for (int i = 0; i < cnt; ++i) {
+        MNode *c = &e->mcts_nodes[first + i];
+        atomic_init(&c->visits, 0);
+        atomic_init(&c->score, 0);
+        atomic_init(&c->child, 0);
+        atomic_init(&c->state, MN_LEAF);
+        c->nchild = 0;
+        c->move = mv[i].from < 0 ? MOVE_NONE : PACK_MOVE(mv[i].from, mv[i].to);
+    }
+    n->nchild = cnt;
+    atomic_store_explicit(&n->child, first, memory_order_relaxed);
+    atomic_store_explicit(&n->state, MN_OPEN, memory_order_release);
+}
+
+/* UCT: 안 가 본 자식이 있으면 (정렬 순으로) 먼저, 아니면 q + C·√(ln N / n) 최대 */
+static MNode *mcts_select(Engine *e, const MNode *n)
+{
+    MNode *c = &e->mcts_nodes[atomic_load_explicit(&n->child, memory_order_relaxed)];
+    double log_n = log((double)atomic_load_explicit(&n->visits, memory_order_relaxed) + 1);
+    MNode *best = c;
+    double best_u = -1;
+    for (int i = 0; i < n->nchild; ++i, ++c) {
+        uint32_t v = atomic_load_explicit(&c->visits, memory_order_relaxed);
+        if (v == 0) return c;
+        double q = atomic_load_explicit(&c->score, memory_order_relaxed) / (2.0 * v);
+        double u = q + MCTS_C * sqrt(log_n / v);
+        if (u > best_u) { best_u = u; best = c; }
+    }
+    return best;
+}
+
+static void *mcts_worker(void *arg)
+{
+    Worker *w = arg;
+    Engine *e = w->eng;
+    MNode *path[MAX_PLY];
+    int    mover[MAX_PLY];          // path[i] 로 온 수를 둔 쪽
+    int    max_len = 0;
+    Undo   u;
+
+    while (!time_exceeded(e)) {
+        Pos p = w->pos;
+        int side = w->side, len = 0, result;
+        MNode *n = e->mcts_nodes;   // 루트
+        mover[0] = side ^ 1;
+
+        for (;;) {
+            path[len++] = n;
+            atomic_fetch_add_explicit(&n->visits, MCTS_VLOSS, memory_order_relaxed);
+            int st = atomic_load_explicit(&n->state, memory_order_acquire);
+            if (st == MN_LEAF && len < MAX_PLY - 1
+                && atomic_load_explicit(&n->visits, memory_order_relaxed) >= MCTS_EXPAND * MCTS_VLOSS) {
+                uint8_t leaf = MN_LEAF;
+                if (atomic_compare_exchange_strong(&n->state, &leaf, MN_BUSY)) {
+                    mcts_expand(e, n, &p, side);
+                    st = atomic_load_explicit(&n->state, memory_order_acquire);
+                }
+            }
+            if (st == MN_OPEN && len < MAX_PLY - 1) {
+                n = mcts_select(e, n);
+                if (n->move != MOVE_NONE)
+                    make_move(&p, side, MOVE_FROM(n->move), MOVE_TO(n->move), &u);
+                mover[len] = side;
+                side ^= 1;
+                continue;
+            }
+            if (st == MN_END) {
+                int diff = bb_count(p.bb[RED]) - bb_count(p.bb[BLUE]);
+                result = diff > 0 ? 2 : diff < 0 ? 0 : 1;
+            } else {
+                result = mcts_playout(&p, side, &w->rng);
+            }
+            break;
+        }
+
+        // 역전파: virtual loss 를 실제 방문 한 번으로, 둔 쪽 기준 점수
+        for (int i = 0; i < len; ++i) {
+            atomic_fetch_sub_explicit(&path[i]->visits, MCTS_VLOSS - 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&path[i]->score,
+                                      mover[i] == RED ? result : 2 - result,
+                                      memory_order_relaxed);
+        }
+        if (len > max_len) max_len = len;
+        if ((++w->nodes & (MCTS_CHECK - 1)) == 0 && w->id == 0
+            && elapsed_time(e) >= e->soft_limit)
+            atomic_store(&e->stop, 1);
+    }
+
+    // 가장 깊이 내려간 길이 (루트 = 1) 를 나무 깊이로
+    int d = atomic_load(&e->mcts_depth);
+    while (max_len - 1 > d && !atomic_compare_exchange_weak(&e->mcts_depth, &d, max_len - 1))
+        ;
+    return NULL;
+}
+
+/* search_prepare 뒤에 부른다.  최다 방문 루트 수와 그 승률 (-1000 ~ 1000),
+   루트를 펼치지 못했으면 (arena 부족) MOVE_NONE */
+static int mcts_run(Engine *e, EngineResult *res)
+{
+    Worker *w0 = &e->workers[0];
+    MNode *root = e->mcts_nodes;
+    atomic_init(&root->visits, 0);
+    atomic_init(&root->score, 0);
+    atomic_init(&root->state, MN_LEAF);
+    atomic_store(&e->mcts_top, 1);
+    atomic_store(&e->mcts_depth, 0);
+    for (int t = 0; t < e->cfg.threads; ++t)
+        e->workers[t].rng = 0x9E3779B97F4A7C15ULL * (t + 1) ^ w0->pos.key;
+
+    uint8_t leaf = MN_LEAF;
+    atomic_compare_exchange_strong(&root->state, &leaf, MN_BUSY);
+    mcts_expand(e, root, &w0->pos, w0->side);
+    if (atomic_load(&root->state) != MN_OPEN) return MOVE_NONE;
+
+    int started = 1;
+    for (int t = 1; t < e->cfg.threads; ++t, ++started)
+        if (pthread_create(&e->workers[t].tid, NULL, mcts_worker, &e->workers[t]) != 0)
+            break;
+    mcts_worker(w0);
+    for (int t = 1; t < started; ++t)
+        pthread_join(e->workers[t].tid, NULL);
+
+    // 결과: 최다 방문 자식을 따라간 수순
+    uint64_t playouts = 0;
+    for (int t = 0; t < started; ++t) playouts += e->workers[t].nodes;
+    res->nodes   = playouts;
+    res->threads = started;
+    res->depth   = atomic_load(&e->mcts_depth);
+    res->pv_len  = 0;
+    const MNode *n = root;
+    int best = MOVE_NONE;
+    while (atomic_load(&n->state) == MN_OPEN && res->pv_len < MAX_PLY) {
+        const MNode *c = &e->mcts_nodes[atomic_load(&n->child)], *pick = c;
+        for (int i = 1; i < n->nchild; ++i)
+            if (atomic_load(&c[i].visits) > atomic_load(&pick->visits)) pick = &c[i];
+        if (atomic_load(&pick->visits) == 0) break;
+        if (n == root) {
+            best = pick->move;
+            uint32_t v = atomic_load(&pick->visits);
+            res->score = (int)lrint((atomic_load(&pick->score) / (double)v - 1) * 1000);
+        }
+        if (pick->move != MOVE_NONE) res->pv[res->pv_len++] = to_engine_move(pick->move);
+        n = pick;
+    }
+    return best;
+}
+
+/* =================================================================
+*                  탐색 통계 로그 (-DOCTAFLIP_STATS)
+*
+*  engine_search 가 끝난 뒤(시간 재기 밖에서) 한 번에 쓴다.
+*    {"type":"iter", ...}  주 스레드가 끝낸 깊이마다, 그 깊이에서 늘어난 양
+*    {"type":"move", ...}  수마다, 모든 스레드 합
+*  bf = 펼친 노드당 탐색한 자식 수, ebf = 직전 깊이 대비 노드 배율,
+*  cut_rate = 펼친 노드 중 β-컷 비율, first_cut_rate = 컷 중 첫 수 컷 비율.
+* =================================================================*/
+#ifdef OCTAFLIP_STATS
+static inline double ratio(uint64_t a, uint64_t b) { return b ? (double)a / b : 0; }
+
+static SearchStats stats_sub(SearchStats a, const SearchStats *b)
+{
+    a.nodes -= b->nodes;          a.qnodes -= b->qnodes;
+    a.interior -= b->interior;    a.children -= b->children;
+    a.cutoffs -= b->cutoffs;      a.first_cutoffs -= b->first_cutoffs;
+    a.tt_probes -= b->tt_probes;  a.tt_hits -= b->tt_hits;
+    a.tt_cutoffs -= b->tt_cutoffs;
+    a.reductions -= b->reductions; a.researches -= b->researches;
+    a.probcuts -= b->probcuts;
+    return a;
+}
+
+static void stats_fields(FILE *fp, const SearchStats *s)
+{
+    fprintf(fp, "\"nodes\":%llu,\"qnodes\":%llu,\"bf\":%.3f,\"cut_rate\":%.4f,"
+            "\"first_cut_rate\":%.4f,\"tt_probes\":%llu,\"tt_hits\":%llu,"
+            "\"tt_hit_rate\":%.4f,\"tt_cutoffs\":%llu,\"reductions\":%llu,"
+            "\"researches\":%llu,\"probcuts\":%llu",
+            (unsigned long long)s->nodes, (unsigned long long)s->qnodes,
+            ratio(s->children, s->interior), ratio(s->cutoffs, s->interior),
+            ratio(s->first_cutoffs, s->cutoffs),
+            (unsigned long long)s->tt_probes, (unsigned long long)s->tt_hits,
+            ratio(s->tt_hits, s->tt_probes), (unsigned long long)s->tt_cutoffs,
+            (unsigned long long)s->reductions, (unsigned long long)s->researches,
+            (unsigned long long)s->probcuts);
+}
+
+static void stats_log(Engine *e, const EngineResult *res, char me, int empties)
+{
+    FILE *fp = e->stats_fp;
+    SearchStats prev = { 0 };
+    uint64_t prev_nodes = 0;
+    for (int i = 0; i < res->iter_cnt; ++i) {
+        const IterInfo *it = &res->iters[i];
+        SearchStats d = stats_sub(it->stats, &prev);
+        fprintf(fp, "{\"type\":\"iter\",\"search\":%d,\"side\":\"%c\",\"depth\":%d,"
+                "\"score\":%d,\"time\":%.6f,\"ebf\":%.3f,",
+                e->search_no, me, it->depth, it->score, it->time,
+                ratio(d.nodes, prev_nodes));
+        stats_fields(fp, &d);
+        fputs("}\n", fp);
+        prev = it->stats;
+        prev_nodes = d.nodes;
+    }
+    fprintf(fp, "{\"type\":\"move\",\"search\":%d,\"side\":\"%c\",\"empties\":%d,"
+            "\"move\":[%d,%d,%d,%d],\"score\":%d,\"depth\":%d,\"solved\":%d,"
+            "\"threads\":%d,\"time\":%.6f,",
+            e->search_no, me, empties, res->move.r1, res->move.c1,
+            res->move.r2, res->move.c2, res->score, res->depth, res->solved,
+            res->threads, res->time);
+    stats_fields(fp, &res->stats);
+    fputs("}\n", fp);
+    fflush(fp);
+}
+
+/* 돈 스레드들의 통계를 합친다 (nodes 는 engine_search 가 채운다) */
+static void stats_total(Engine *e, int started, EngineResult *res)
+{
+    SearchStats *t = &res->stats;
+    for (int i = 0; i < started; ++i) {
+        const Worker *w = &e->workers[i];
+        t->qnodes += w->stats.qnodes;
+        t->interior += w->stats.interior;   t->children += w->stats.children;
+        t->cutoffs += w->stats.cutoffs;     t->first_cutoffs += w->stats.first_cutoffs;
+        t->tt_probes += w->stats.tt_probes; t->tt_hits += w->stats.tt_hits;
+        t->tt_cutoffs += w->stats.tt_cutoffs;
+        t->reductions += w->stats.reductions; t->researches += w->stats.researches;
+        t->probcuts += w->stats.probcuts;
+    }
+}
+#endif
+
+/* =================================================================
+*                  API
+* =================================================================*/
+Engine *engine_create(const EngineConfig *cfg)
+{
+    init_bitboards();
+    Engine *e = calloc(1, sizeof(Engine));
+    if (!e) return NULL;
+    e->cfg = *cfg;
+    if (e->cfg.threads < 1)           e->cfg.threads = 1;
+    if (e->cfg.threads > MAX_THREADS) e->cfg.threads = MAX_THREADS;
+    if (e->cfg.hash_mb == 0)          e->cfg.hash_mb = 1;
+
+    void *mem = NULL;
+    if (posix_memalign(&mem, 64, e->cfg.threads * sizeof(Worker)) != 0) {
+        free(e);
+        return NULL;
+    }
+    memset(mem, 0, e->cfg.threads * sizeof(Worker));
+    e->workers = mem;
+    // MCTS 면 hash_mb 는 노드 arena 몫이고 치환표는 최소 크기 (쓰이지 않음)
+    if (e->cfg.mcts) {
+        size_t n = (e->cfg.hash_mb << 20) / sizeof(MNode);
+        e->mcts_cap = n > UINT32_MAX ? UINT32_MAX : (uint32_t)n;
+        e->mcts_nodes = malloc((size_t)e->mcts_cap * sizeof(MNode));
+        if (!e->mcts_nodes) {
+            free(e->workers);
+            free(e);
+            return NULL;
+        }
+    }
+    if (tt_init(&e->tt, e->cfg.mcts ? 1 : e->cfg.hash_mb) < 0) {
+        free(e->mcts_nodes);
+        free(e->workers);
+        free(e);
+        return NULL;
+    }
+    // 캐시 tag: 점수의 뜻을 정하는 평가 함수 (고전 평가면 0)
+    if ((e->cfg.eval_file && !(e->nn = nn_load(e->cfg.eval_file)))
+        || (e->cfg.book_file && !(e->book = book_open(e->cfg.book_file)))
+        || (e->cfg.cache_file
+            && !(e->cache = cache_open(e->cfg.cache_file, e->cfg.cache_mb,
+                                       e->nn ? nn_hash(e->nn) : 0)))) {
+        nn_free(e->nn);
+        book_close(e->book);
+        free(e->tt.b);
+        free(e->mcts_nodes);
+        free(e->workers);
+        free(e);
+        return NULL;
+    }
+    if (e->cfg.stats_log) {
+#ifdef OCTAFLIP_STATS
+        e->stats_fp = fopen(e->cfg.stats_log, "a");
+        if (!e->stats_fp) perror("[Engine] open stats log");
+#else
+        fprintf(stderr, "[Engine] stats log ignored: built without -DOCTAFLIP_STATS\n");
+#endif
+    }
+    return e;
+}
+
+void engine_destroy(Engine *e)
+{
+    if (!e) return;
+    engine_ponder_stop(e);
+    if (e->stats_fp) fclose(e->stats_fp);
+    free(e->tt.b);
+    free(e->eg_hash);
+    nn_free(e->nn);
+    book_close(e->book);
+    cache_close(e->cache);
+    free(e->mcts_nodes);
+    free(e->workers);
+    free(e);
+}
+
+EngineConfig *engine_config(Engine *e) { return &e->cfg; }
+
+void engine_clear(Engine *e)
+{
+    memset(e->tt.b, 0, (e->tt.mask + 1) * sizeof(TTBucket));
+    e->tt.gen = 0;
+    if (e->eg_hash)
+        memset(e->eg_hash, 0, sizeof(EGEntry) << EG_HASH_BITS);
+    for (int t = 0; t < e->cfg.threads; ++t)
+        memset(e->workers[t].history, 0, sizeof(e->workers[t].history));
+}
+
+void engine_search(Engine *e, char board[SIZE][SIZE], char me, double timeout,
+                   EngineResult *res)
+{
+    Pos root;
+    board_to_pos(board, &root);
+    int side = color_index(me);
+    Worker *w0 = &e->workers[0];
+
+    // 초반엔 수가 거의 결정적이라 덜 쓰고, 후반일수록 끝까지 읽는다
+    int empties = bb_count(empty_bb(&root));
+    double soft_frac = empties > NSQ * 2 / 3 ? 0.6
+                     : empties > 16          ? 0.8 : 1.0;
+    if (isinf(timeout)) time_init_unlimited(e);
+    else                time_init(e, timeout, soft_frac);
+    tt_new_search(&e->tt);
+
+    search_prepare(e, &root, side);
+
+    res->move     = to_engine_move(MOVE_NONE);
+    res->score    = 0;
+    res->depth    = 0;
+    res->solved   = 0;
+    res->book     = 0;
+    res->cached   = 0;
+    res->nodes    = 0;
+    res->threads  = 1;
+    res->iter_cnt = 0;
+    res->pv_len   = 0;
+    res->stats    = (SearchStats){ 0 };
+    ++e->search_no;
+
+    // 둘 수가 없으면 패스
+    if (w0->root_cnt == 0) {
+        res->time = elapsed_time(e);
+#ifdef OCTAFLIP_STATS
+        if (e->stats_fp) stats_log(e, res, me, empties);
+#endif
+        return;
+    }
+
+    // opening book 에 있으면 탐색 없이
+    int from, to;
+    if (e->book && book_probe(e->book, &root, side, &from, &to, &res->score, &res->depth)) {
+        res->move = to_engine_move(PACK_MOVE(from, to));
+        res->book = 1;
+        res->pv[0] = res->move;
+        res->pv_len = 1;
+        res->time = elapsed_time(e);
+#ifdef OCTAFLIP_STATS
+        if (e->stats_fp) stats_log(e, res, me, empties);
+#endif
+        return;
+    }
+
+    // 종반: 먼저 완전 탐색으로 풀어 보고, 못 풀면 남은 시간에 일반 탐색
+    if (empties <= e->cfg.endgame_empties) {
+        if (!e->eg_hash)
+            e->eg_hash = calloc((size_t)1 << EG_HASH_BITS, sizeof(EGEntry));
+        if (e->eg_hash) {
+            int move, score, exact;
+            double hard = e->hard_limit;
+            e->hard_limit = hard * EG_TIME_FRAC;
+            int solved = endgame_solve(w0, &move, &score, &exact);
+            e->hard_limit = hard;
+            if (solved) {
+                res->move   = to_engine_move(move);
+                res->score  = score;
+                res->solved = exact ? 2 : 1;
+                res->nodes  = w0->nodes;
+                res->stats.nodes = w0->nodes;
+                res->time   = elapsed_time(e);
+#ifdef OCTAFLIP_STATS
+                if (e->stats_fp) stats_log(e, res, me, empties);
+#endif
+                return;
+            }
+            atomic_store(&e->stop, 0);
+            w0->nodes = 0;
+            // 증명은 못 했어도 solver 가 고른 수를 일반 탐색의 첫 후보로
+            if (move != MOVE_NONE)
+                root_promote(e, move & 0xFF, move >> 8);
+        }
+    }
+
+    if (e->cfg.mcts) {
+        int best = mcts_run(e, res);
+        if (best == MOVE_NONE)
+            best = PACK_MOVE(w0->root_moves[0].from, w0->root_moves[0].to);
+        res->move = to_engine_move(best);
+        res->time = elapsed_time(e);
+        res->stats.nodes = res->nodes;
+#ifdef OCTAFLIP_STATS
+        if (e->stats_fp) stats_log(e, res, me, empties);
+#endif
+        return;
+    }
+
+    // 디스크 캐시: 무제한 탐색이 이미 max_depth 만큼 읽혀 있으면 그대로,
+    // 아니면 그 수를 모든 스레드의 루트 첫 후보로
+    int c_from, c_to, c_score, c_depth = 0;
+    if (e->cache && !cache_probe(e->cache, &root, side, e->cfg.max_depth,
+                                 &c_from, &c_to, &c_score, &c_depth))
+        c_depth = 0;
+    if (c_depth > 0 && isinf(timeout) && c_depth >= e->cfg.max_depth) {
+        res->move   = to_engine_move(PACK_MOVE(c_from, c_to));
+        res->score  = c_score;
+        res->depth  = c_depth;
+        res->cached = 1;
+        res->pv[0]  = res->move;
+        res->pv_len = 1;
+        res->time   = elapsed_time(e);
+#ifdef OCTAFLIP_STATS
+        if (e->stats_fp) stats_log(e, res, me, empties);
+#endif
+        return;
+    }
+    if (c_depth > 0)
+        root_promote(e, c_from, c_to);
+
+    int started = search_run(e);
+
+    // 가장 깊이 끝낸 스레드의 수 (같으면 주 스레드 우선)
+    int best = w0->best_move, best_depth = w0->best_depth;
+    uint64_t nodes = w0->nodes;
+    for (int t = 1; t < started; ++t) {
+        nodes += e->workers[t].nodes;
+        if (e->workers[t].best_depth > best_depth) {
+            best_depth = e->workers[t].best_depth;
+            best = e->workers[t].best_move;
+        }
+    }
+
+    // 후보가 있었는데 탐색이 안 끝나서 best가 갱신되지 않은 경우 무조건 하나라도 두기
+    if (best == MOVE_NONE)
+        best = PACK_MOVE(w0->root_moves[0].from, w0->root_moves[0].to);
+
+    res->move     = to_engine_move(best);
+    res->score    = w0->best_score;
+    res->depth    = w0->best_depth;
+    res->nodes    = nodes;
+    res->time     = elapsed_time(e);
+    res->threads  = started;
+    res->iter_cnt = w0->iter_cnt;
+    memcpy(res->iters, w0->iters, w0->iter_cnt * sizeof(IterInfo));
+    fill_pv(w0, res);
+    res->stats.nodes = nodes;
+    // 캐시 쪽이 더 깊게 읽었으면 그 결과, 아니면 이번 결과를 써 넣는다
+    if (c_depth > best_depth) {
+        res->move   = to_engine_move(PACK_MOVE(c_from, c_to));
+        res->score  = c_score;
+        res->depth  = c_depth;
+        res->cached = 1;
+        res->pv[0]  = res->move;
+        res->pv_len = 1;
+    } else if (e->cache && best_depth > 0 && w0->best_depth == best_depth) {
+        cache_store(e->cache, &root, side, e->cfg.max_depth,
+                    best & 0xFF, best >> 8, w0->best_score, best_depth);
+    }
+#ifdef OCTAFLIP_STATS
+    stats_total(e, started, res);
+    if (e->stats_fp) stats_log(e, res, me, empties);
+#endif
+}
+
+/* ====================
+Pondering: 내 수를 보낸 뒤 상대 차례 국면을 백그라운드로 탐색해
+치환표를 채워 둔다.  상대의 모든 응수가 루트 후보이므로, 실제 보드가
+오면 해당 하위 트리의 결과를 그대로 이어 쓴다.
+==================== */
+static void *ponder_main(void *arg)
+{
+    search_run(arg);
+    return NULL;
+}
+
+void engine_ponder_start(Engine *e, char board[SIZE][SIZE], char me,
+                         int r1, int c1, int r2, int c2)
+{
+    if (e->cfg.mcts) return;       // MCTS 는 수마다 나무를 새로 키운다
+    Pos root;
+    board_to_pos(board, &root);
+    int side = color_index(me);
+    if (r1 >= 0) {
+        Undo u;
+        make_move(&root, side, r1 * SIZE + c1, r2 * SIZE + c2, &u);
+    }
+    time_init_unlimited(e);
+    tt_new_search(&e->tt);
+    search_prepare(e, &root, side ^ 1);
+    e->pondering = (pthread_create(&e->ponder_tid, NULL, ponder_main, e) == 0);
+}
+
+/* 메시지가 오면 즉시 호출: 모든 탐색 스레드가 다음 노드에서 멈춘다 */
+void engine_ponder_stop(Engine *e)
+{
+    if (!e->pondering) return;
+    atomic_store(&e->stop, 1);
+    pthread_join(e->ponder_tid, NULL);
+    e->pondering = 0;
+}
@@ -0,0 +1,360 @@
+/********************************************************************
+ *  engine.h ― OctaFlip 탐색 엔진 (client2 / client4 / 도구 공용)
+ *
+ *  보드 크기는 컴파일할 때 정한다:  -DOCTAFLIP_SIZE=N  (6 ~ 10, 기본 8)
+ *    - N ≤ 8 : 비트보드 = uint64_t
+ *    - N ≥ 9 : 비트보드 = unsigned __int128 (GCC/Clang)
+ *  SIZE·NSQ·가장자리 마스크가 모두 상수라, 복제/점프 대상을 구하는
+ *  shift 연산과 마스크는 크기마다 상수로 접혀 들어간다.
+ *  엔진과 그것을 쓰는 프로그램은 같은 OCTAFLIP_SIZE 로 빌드해야 한다.
+ *
+ *  사용 순서
+ *      Engine *e = engine_create(&cfg);
+ *      engine_search(e, board, 'R', timeout, &res);     // 수마다
+ *      engine_ponder_start(e, ...); engine_ponder_stop(e);  // 선택
+ *      engine_destroy(e);
+ *
+ *  아래쪽 비트보드 계층(Pos, gen_moves, make/unmake, evaluate_board)은
+ *  perft·bench 같은 도구가 직접 쓸 수 있도록 헤더에 inline 으로 둔다.
+ *******************************************************************/
+#ifndef OCTAFLIP_ENGINE_H
+#define OCTAFLIP_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef OCTAFLIP_SIZE
+#define OCTAFLIP_SIZE 8
+#endif
+#if OCTAFLIP_SIZE < 6 || OCTAFLIP_SIZE > 10
+#error "OCTAFLIP_SIZE must be between 6 and 10"
+#endif
+
+#define SIZE        OCTAFLIP_SIZE
+#define NSQ         (SIZE * SIZE)
+#define MAX_MOVES   (NSQ * 9 / 2)   /* 점프 ≤ 8·min(말, 빈칸), 복제 ≤ 빈칸 */
+#define MAX_PLY     128
+#define MAX_THREADS 64
+
+/* =================================================================
+*                  비트보드 (칸 번호 sq = r * SIZE + c)
+*
+*  색마다 비트보드 하나씩 두고, 복제(1칸)·점프(2칸) 대상은 미리 계산한
+*  마스크와 shift 로 구한다.  NSQ 가 워드보다 작으면 위쪽 비트는 쓰지
+*  않으므로 shift 결과를 BB_FULL 로 자른다 (8x8 에서는 사라지는 AND).
+* =================================================================*/
+#if SIZE <= 8
+typedef uint64_t bb_t;
+static inline int bb_count(bb_t b) { return __builtin_popcountll(b); }
+static inline int bb_lsb(bb_t b)   { return __builtin_ctzll(b); }
+#else
+typedef unsigned __int128 bb_t;
+static inline int bb_count(bb_t b)
+{
+    return __builtin_popcountll((uint64_t)b) + __builtin_popcountll((uint64_t)(b >> 64));
+}
+static inline int bb_lsb(bb_t b)
+{
+    uint64_t lo = (uint64_t)b;
+    return lo ? __builtin_ctzll(lo) : 64 + __builtin_ctzll((uint64_t)(b >> 64));
+}
+#endif
+
+#define BB_BITS    ((int)(8 * sizeof(bb_t)))
+#define BB_SQ(s)   (((bb_t)1) << (s))
+#define BB_FULL    (NSQ == BB_BITS ? ~(bb_t)0 : BB_SQ(NSQ % BB_BITS) - 1)
+#define BB_FILE_A  (BB_FULL / (BB_SQ(SIZE) - 1))     /* 각 줄의 0번 칸 */
+#define BB_NOT_E1  (~(BB_FILE_A << (SIZE - 1)))
+#define BB_NOT_E2  (BB_NOT_E1 & ~(BB_FILE_A << (SIZE - 2)))
+#define BB_NOT_W1  (~BB_FILE_A)
+#define BB_NOT_W2  (BB_NOT_W1 & ~(BB_FILE_A << 1))
+
+enum { RED = 0, BLUE = 1 };
+
+typedef struct {
+    bb_t     bb[2];             /* bb[RED], bb[BLUE] */
+    bb_t     blocked;           /* '.'도 말도 아닌 칸 (있다면) */
+    uint64_t key;               /* 말 배치의 Zobrist 해시 (차례 제외) */
+} Pos;
+
+typedef struct {
+    int from, to;
+    int score;                  /* 정렬용 점수 */
+} Move;
+
+/* make/unmake 되돌리기 정보: 뒤집힌 말, 움직인 칸(점프면 출발 칸 포함), 이전 키 */
+typedef struct {
+    bb_t     flips;
+    bb_t     moved;
+    uint64_t key;
+} Undo;
+
+extern bb_t     ADJ[NSQ];           /* sq 주변 8칸 (복제 대상) */
+extern bb_t     JUMP[NSQ];          /* sq에서 8방향 2칸 (점프 대상) */
+extern uint64_t ZOB[2][NSQ];        /* 색·칸별 Zobrist 키 */
+extern uint64_t ZOB_FLIP[NSQ];      /* ZOB[RED][sq] ^ ZOB[BLUE][sq] */
+extern uint64_t ZOB_SIDE[2];        /* 둘 차례: RED = 0 */
+
+/* =================================================================
+*                  대칭 (회전·뒤집기 8 가지 × 색 바꾸기)
+*
+*  sym (0 ~ 7) 은 칸 (r, c) 에 bit2 = 전치 (r↔c), bit1 = 상하, bit0 = 좌우
+*  뒤집기를 이 순서로 적용한다.  0 은 항등.
+*  정규형: 둘 차례를 RED 자리로 옮긴 뒤 (색 바꾸기) 8 가지 중
+*  (bb[RED], bb[BLUE], blocked) 가 가장 작은 것.  대칭인 국면끼리 같은
+*  정규형·key 를 가지므로 치환표·opening book·캐시가 항목을 나눠 쓸 수
+*  있다 (대칭 국면 근처에서 최대 16 배).  수는 sq_transform 으로 옮기고
+*  sym_inverse 로 되돌린다.  색 바꾸기는 칸을 바꾸지 않는다.
+* =================================================================*/
+#define SYM_COUNT 8
+
+extern uint8_t  SYM_SQ[SYM_COUNT][NSQ];  /* sym 을 적용한 뒤의 칸 번호 */
+
+/* 위 표를 채운다.  여러 번 불러도 한 번만 실행된다 */
+void init_bitboards(void);
+
+/* 문자 보드 → 비트보드 */
+void board_to_pos(char bd[SIZE][SIZE], Pos *p);
+
+static inline int bb_pop(bb_t *b)
+{
+    int s = bb_lsb(*b);
+    *b &= *b - 1;
+    return s;
+}
+
+/* b의 모든 말에서 1칸 떨어진 칸 */
+static inline bb_t bb_adjacent(bb_t b)
+{
+    bb_t e = (b & BB_NOT_E1) << 1, w = (b & BB_NOT_W1) >> 1;
+    bb_t row = b | e | w;
+    return ((row << SIZE) | (row >> SIZE) | e | w) & BB_FULL;
+}
+
+/* b의 모든 말에서 8방향으로 정확히 2칸 떨어진 칸 */
+static inline bb_t bb_jumps(bb_t b)
+{
+    bb_t e = (b & BB_NOT_E2) << 2, w = (b & BB_NOT_W2) >> 2;
+    bb_t row = b | e | w;
+    return ((row << 2 * SIZE) | (row >> 2 * SIZE) | e | w) & BB_FULL;
+}
+
+static inline int color_index(char c) { return c == 'R' ? RED : BLUE; }
+
+static inline bb_t empty_bb(const Pos *p)
+{
+    return ~(p->bb[RED] | p->bb[BLUE] | p->blocked) & BB_FULL;
+}
+
+/* 이동을 보드에 직접 적용: 뒤집기 = 주변 마스크 AND 상대 */
+static inline void make_move(Pos *p, int side, int from, int to, Undo *u)
+{
+    bb_t flips = ADJ[to] & p->bb[side ^ 1];
+    bb_t moved = BB_SQ(to);
+    uint64_t key = p->key ^ ZOB[side][to];
+    if (!(ADJ[from] & BB_SQ(to))) {         /* 점프면 출발 칸을 비움 */
+        moved |= BB_SQ(from);
+        key ^= ZOB[side][from];
+    }
+    u->flips = flips;
+    u->moved = moved;
+    u->key   = p->key;
+    p->bb[side]     ^= moved | flips;
+    p->bb[side ^ 1] ^= flips;
+    for (bb_t f = flips; f; )
+        key ^= ZOB_FLIP[bb_pop(&f)];
+    p->key = key;
+}
+
+static inline void unmake_move(Pos *p, int side, const Undo *u)
+{
+    p->bb[side]     ^= u->moved | u->flips;
+    p->bb[side ^ 1] ^= u->flips;
+    p->key = u->key;
+}
+
+/* 합법 수 생성.  복제는 결과가 출발 칸과 무관하므로 목표 칸당 하나만 만든다. */
+static inline int gen_moves(const Pos *p, int side, Move *mv)
+{
+    bb_t own = p->bb[side], empty = empty_bb(p);
+    int n = 0;
+
+    bb_t clone = bb_adjacent(own) & empty;
+    while (clone) {
+        int to = bb_pop(&clone);
+        mv[n++] = (Move){ bb_lsb(ADJ[to] & own), to, 0 };
+    }
+    bb_t src = own;
+    while (src) {
+        int from = bb_pop(&src);
+        bb_t tgt = JUMP[from] & empty;
+        while (tgt) mv[n++] = (Move){ from, bb_pop(&tgt), 0 };
+    }
+    return n;
+}
+
+static inline int sq_transform(int sq, int sym) { return SYM_SQ[sym][sq]; }
+
+/* 전치가 있으면 뒤집기 둘의 순서가 바뀐다 */
+static inline int sym_inverse(int sym)
+{
+    return (sym & 4) ? 4 | (sym & 1) << 1 | (sym & 2) >> 1 : sym;
+}
+
+/* 비트보드 전체에 sym 적용.  8x8 은 bswap·delta swap 몇 번, 그 밖은 말마다 표 */
+static inline bb_t bb_transform(bb_t b, int sym)
+{
+#if SIZE == 8
+    if (sym & 4) {
+        bb_t t;
+        t = 0x0F0F0F0F00000000ULL & (b ^ (b << 28)); b ^= t ^ (t >> 28);
+        t = 0x3333000033330000ULL & (b ^ (b << 14)); b ^= t ^ (t >> 14);
+        t = 0x5500550055005500ULL & (b ^ (b <<  7)); b ^= t ^ (t >>  7);
+    }
+    if (sym & 2) b = __builtin_bswap64(b);
+    if (sym & 1) {
+        b = ((b >> 1) & 0x5555555555555555ULL) | ((b & 0x5555555555555555ULL) << 1);
+        b = ((b >> 2) & 0x3333333333333333ULL) | ((b & 0x3333333333333333ULL) << 2);
+        b = ((b >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((b & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    }
+    return b;
+#else
+    if (sym == 0) return b;
+    bb_t out = 0;
+    while (b) out |= BB_SQ(SYM_SQ[sym][bb_pop(&b)]);
+    return out;
+#endif
+}
+
+/* dst = src 에 sym 적용 (key 도 다시 계산).  dst == src 여도 된다 */
+void pos_transform(const Pos *src, int sym, Pos *dst);
+
+/* side 차례 국면 p 의 정규형 (둘 차례가 RED 자리).  고른 sym 을 돌려준다:
+   p 의 칸 sq 는 out 의 sq_transform(sq, sym) */
+int pos_canonical(const Pos *p, int side, Pos *out);
+
+/* 정규형 국면의 key: 말 배치 Zobrist + 막힌 칸 (book·디스크 캐시용) */
+uint64_t canon_key(const Pos *canon);
+
+/* 말이 아직 움직일 수 있는지 검사 (턴 건너뛰기 여부 체크) */
+static inline int has_moves(const Pos *p, int side)
+{
+    bb_t own = p->bb[side];
+    return ((bb_adjacent(own) | bb_jumps(own)) & empty_bb(p)) != 0;
+}
+
+/* 보드 평가 함수: 말 수 차이 + 모빌리티(둘 곳이 있는 말 수) 차이, side 관점 */
+static inline int evaluate_board(const Pos *p, int side)
+{
+    bb_t empty = empty_bb(p);
+    bb_t movable = bb_adjacent(empty) | bb_jumps(empty);
+    bb_t me = p->bb[side], op = p->bb[side ^ 1];
+    int piece_diff = bb_count(me) - bb_count(op);
+    int mob_diff   = bb_count(me & movable) - bb_count(op & movable);
+    return piece_diff * 100 + mob_diff * 10;
+}
+
+/* =================================================================
+*                          엔진 API
+* =================================================================*/
+typedef struct Engine Engine;
+
+typedef struct {
+    int    threads;             /* Lazy SMP 스레드 수 (1 ~ MAX_THREADS) */
+    size_t hash_mb;             /* 치환표 크기 (MB) */
+    int    max_depth;           /* 반복 심화 최대 깊이 */
+    int    endgame_empties;     /* 빈칸이 이 이하면 종반 solver 먼저 (0 = 끔).
+                                   점프 때문에 6 칸 넘게는 제 시간에 증명하는 일이 드물다 */
+    const char *stats_log;      /* 탐색 통계 JSON lines 파일 (-DOCTAFLIP_STATS 빌드만) */
+    const char *eval_file;      /* 신경망 평가 가중치 (nnue.h), NULL 이면 evaluate_board */
+    int    mcts;                /* 1 이면 α-β 대신 MCTS (hash_mb 는 노드 arena 크기) */
+    const char *book_file;      /* opening book (book.h), 있으면 탐색 전에 찾아본다 */
+    const char *cache_file;     /* 디스크 국면 캐시 (cache.h), 프로세스끼리 나눠 쓴다 */
+    size_t cache_mb;            /* 캐시 파일을 새로 만들 때 크기 (MB) */
+} EngineConfig;
+
+#define ENGINE_CONFIG_DEFAULT { .threads = 1, .hash_mb = 64, .max_depth = 64, \
+                                .endgame_empties = 5,  .stats_log = NULL, \
+                                .eval_file = NULL, .mcts = 0, .book_file = NULL, \
+                                .cache_file = NULL, .cache_mb = 64 }
+
+/* 탐색 통계.  engine.c 를 -DOCTAFLIP_STATS 로 빌드했을 때만 센다
+   (아니면 세는 코드 자체가 없고 nodes 외에는 모두 0). */
+typedef struct {
+    uint64_t nodes;             /* 방문 노드 */
+    uint64_t qnodes;            /* 그중 정지 탐색 노드 */
+    uint64_t interior;          /* 자식을 펼친 노드 */
+    uint64_t children;          /* 펼쳐서 실제로 탐색한 자식 수 */
+    uint64_t cutoffs;           /* β-컷 난 노드 */
+    uint64_t first_cutoffs;     /* 그중 첫 수에서 컷 */
+    uint64_t tt_probes;
+    uint64_t tt_hits;
+    uint64_t tt_cutoffs;        /* 치환표 값으로 바로 돌아간 노드 */
+    uint64_t reductions;        /* LMR 로 줄여 읽은 수 */
+    uint64_t researches;        /* 그중 α를 넘어 원래 깊이로 다시 읽은 수 */
+    uint64_t probcuts;          /* ProbCut 으로 자른 노드 */
+} SearchStats;
+
+typedef struct {
+    int r1, c1, r2, c2;         /* 0부터 센 좌표, 패스면 모두 -1 */
+} EngineMove;
+
+/* 끝낸 반복 하나의 기록 */
+typedef struct {
+    int      depth;
+    int      score;
+    int      move;                  /* from | to << 8 */
+    double   time;                  /* 시작부터 이 깊이를 끝낼 때까지 (초) */
+    uint64_t nodes;
+    SearchStats stats;              /* 이 깊이를 끝낸 시점까지의 누적 (주 스레드) */
+} IterInfo;
+
+#define SCORE_WIN 500000000          /* 일반 탐색이 승패를 읽었을 때의 점수 (지면 음수) */
+
+typedef struct {
+    EngineMove move;
+    int        score;           /* 둘 차례 관점. solver 로 풀었으면 최종 말 수 차이 */
+    int        depth;           /* 끝낸 깊이 (solver 로 풀었으면 0) */
+    int        solved;          /* 0: 일반 탐색, 1: solver 승/무/패만, 2: solver 정확 */
+    int        book;            /* 1: opening book 수 (depth·score 는 book 을 만들 때 값) */
+    int        cached;          /* 1: 디스크 캐시 쪽이 더 깊어 그 수·점수·깊이를 씀 */
+    uint64_t   nodes;           /* 모든 스레드 합 */
+    double     time;            /* 탐색에 쓴 시간 (초) */
+    int        threads;         /* 실제로 돈 스레드 수 */
+    IterInfo   iters[MAX_PLY];  /* 주 스레드가 끝낸 반복들 */
+    int        iter_cnt;
+    EngineMove pv[MAX_PLY];     /* 주 스레드 PV, 복제 출발 칸까지 복원 */
+    int        pv_len;
+    SearchStats stats;          /* 모든 스레드 합 */
+} EngineResult;
+
+/* 엔진 하나 = 치환표 + 탐색 스레드들.  실패하면 NULL (eval_file, book_file, cache_file 을 못 열 때도) */
+Engine *engine_create(const EngineConfig *cfg);
+void    engine_destroy(Engine *e);
+
+/* max_depth, endgame_empties 는 탐색 사이에 바꿔도 된다.
+   threads, hash_mb, eval_file, mcts, book_file, cache_file 은 engine_create 때 값으로 고정. */
+EngineConfig *engine_config(Engine *e);
+
+/* 치환표·history 를 비운다 (서로 독립인 국면을 잴 때) */
+void engine_clear(Engine *e);
+
+/* 서버가 준 한 수 시간을 초로: 100 넘으면 ms 로 온 것 */
+static inline double engine_timeout_secs(double timeout)
+{
+    return timeout > 100 ? timeout / 1000.0 : timeout;
+}
+
+/* me 차례의 최선 수.  timeout 은 서버가 준 한 수 시간(초, 100 넘으면 ms):
+   네트워크 여유분을 뺀 안에서 끝낸다.  INFINITY 면 max_depth 까지 다 읽는다
+   (MCTS 는 노드 arena 가 찰 때까지). */
+void engine_search(Engine *e, char board[SIZE][SIZE], char me, double timeout,
+                   EngineResult *res);
+
+/* 내가 (r1,c1)->(r2,c2) 를 둔 뒤 상대 차례를 백그라운드로 읽어 치환표를
+   채운다 (패스면 r1 < 0).  다음 engine_search 전에 반드시 stop. */
+void engine_ponder_start(Engine *e, char board[SIZE][SIZE], char me,
+                         int r1, int c1, int r2, int c2);
+void engine_ponder_stop(Engine *e);
+
+#endif /* OCTAFLIP_ENGINE_H */
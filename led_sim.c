@@ -0,0 +1,57 @@
+/********************************************************************
+ *  led_sim.c ― LED 매트릭스 시뮬레이터
+ *
+ *  client4 를 LED 하드웨어 없이 돌리고 렌더링 경로를 잴 때
+ *  LED 프로젝트의 update_led_matrix() 대신 링크한다.
+ *
+ *  빌드:
+ *      gcc -DBENCH_CLIENT4 bench.c client4.o led_sim.c engine.c nnue.c book.c cache.c -o bench -O2 -Wall -Wextra -lm -pthread
+ *******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include "led_sim.h"
+
+uint8_t  led_sim_frame[SIZE][SIZE][3];
+long     led_sim_delay_us = -1;
+_Atomic uint64_t led_sim_frames;
+_Atomic uint64_t led_sim_busy_ns;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+void update_led_matrix(char board[SIZE][SIZE])
+{
+    uint64_t t0 = now_ns();
+    if (led_sim_delay_us < 0) {
+        const char *env = getenv("OCTAFLIP_LED_DELAY_US");
+        led_sim_delay_us = env ? atol(env) : 0;
+    }
+
+    // 빨강 = R, 파랑 = B, 빈칸 = 끔, 막힌 칸 = 흐린 흰색
+    for (int r = 0; r < SIZE; ++r) {
+        for (int c = 0; c < SIZE; ++c) {
+            uint8_t *px = led_sim_frame[r][c];
+            px[0] = px[1] = px[2] = 0;
+            if      (board[r][c] == 'R') px[0] = 255;
+            else if (board[r][c] == 'B') px[2] = 255;
+            else if (board[r][c] != '.') px[0] = px[1] = px[2] = 32;
+        }
+    }
+
+    // 느린 드라이버 I/O 흉내
+    if (led_sim_delay_us > 0) {
+        struct timespec ts = { led_sim_delay_us / 1000000,
+                               (led_sim_delay_us % 1000000) * 1000 };
+        while (nanosleep(&ts, &ts) != 0 && errno == EINTR) ;     // 남은 시간만큼 다시
+    }
+    atomic_fetch_add(&led_sim_busy_ns, now_ns() - t0);
+    atomic_fetch_add(&led_sim_frames, 1);
+}
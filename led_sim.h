@@ -0,0 +1,22 @@
+/********************************************************************
+ *  led_sim.h ― LED 매트릭스 시뮬레이터 (하드웨어 없는 곳에서 client4 용)
+ *
+ *  led_sim.c 가 LED 프로젝트의 update_led_matrix() 를 대신한다.
+ *  보드를 메모리 안의 RGB 프레임으로 그리고, 드라이버 I/O 가 느린 상황은
+ *  led_sim_delay_us 로 흉내 낸다 (환경 변수 OCTAFLIP_LED_DELAY_US 로도).
+ *******************************************************************/
+#ifndef OCTAFLIP_LED_SIM_H
+#define OCTAFLIP_LED_SIM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "engine.h"
+
+extern uint8_t  led_sim_frame[SIZE][SIZE][3];   /* 마지막으로 그린 프레임 (RGB) */
+extern long     led_sim_delay_us;               /* 프레임마다 흉내 낼 지연, <0 이면 환경 변수 */
+extern _Atomic uint64_t led_sim_frames;         /* 그린 프레임 수 */
+extern _Atomic uint64_t led_sim_busy_ns;        /* update_led_matrix 안에서 쓴 시간 합 */
+
+void update_led_matrix(char board[SIZE][SIZE]);
+
+#endif /* OCTAFLIP_LED_SIM_H */
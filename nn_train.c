@@ -0,0 +1,401 @@
+/********************************************************************
+ *  nn_train.c ― 신경망 평가(nnue.h) 가중치 만들기
+ *
+ *  1) 자가 대국으로 국면을 모은다.  수마다 라벨용 탐색의 최선 수를 두되
+ *     일정 확률로 무작위 수를 섞어 초반~종반을 고루 만든다.
+ *  2) 각 국면을 고정 깊이로 탐색한 점수(둘 차례 관점)를 정답으로 삼는다.
+ *     라벨 엔진은 기본이 evaluate_board, -label <weights> 면 그 신경망
+ *     (앞 세대 가중치로 다음 세대를 만드는 반복 학습).
+ *  3) float 로 학습(Adam, MSE)한 뒤 양자화해서 저장한다.
+ *     |w1|, |w2| 는 nnue.h 의 int16 범위 조건에 맞게 학습 중에 자른다.
+ *
+ *  모은 국면은 -data <file> 로 저장해 두고, 파일이 이미 있으면 다시
+ *  만들지 않고 읽는다 (학습 설정만 바꿔 볼 때).
+ *
+ *  빌드:
+ *      gcc nn_train.c engine.c nnue.c book.c cache.c -o nn_train -O2 -Wall -Wextra -lm -pthread
+ *
+ *  실행 예:
+ *      ./nn_train -positions 200000 -depth 4 -data d4.bin -o octaflip.nn
+ *      ./nn_train -positions 200000 -label octaflip.nn -data gen2.bin -o gen2.nn
+ *******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "engine.h"
+#include "nnue.h"
+
+#define H            NN_HIDDEN
+#define NIN          (2 * NSQ)
+#define RANDOM_PCT   20         /* 대국 생성 중 무작위 수 비율 (%) */
+#define SKIP_PLIES   2          /* 시작 직후 국면은 모으지 않는다 */
+#define MAX_PLIES    1000       /* 점프만 반복하는 대국을 끊는다 (server.c MAX_TURNS) */
+#define SCORE_CLAMP  (NSQ * 50) /* 승패 점수(±INF/2)를 이 안으로 */
+#define VALID_PCT    5          /* 검증용으로 떼어 둘 비율 (%) */
+#define BATCH        256
+
+/* int16 조건: b1 + 특징 NSQ 개의 합이 넘치지 않게 */
+#define W1_MAX       (32000.0f / NN_QA / (NSQ + 1))
+#define W2_MAX       (32000.0f / NN_QB / 100)
+
+/* 학습 국면 하나: 둘 차례 관점의 내 말 / 상대 말, 탐색 점수 */
+typedef struct {
+    bb_t    own, opp;
+    int32_t score;
+} Sample;
+
+/* ───── 난수 (xorshift64*) ───────────────────────────────────────── */
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rng_next(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static float rng_uniform(float lo, float hi)
+{
+    return lo + (hi - lo) * (float)((rng_next() >> 40) / 16777216.0);
+}
+
+/* ───── 국면 모으기 ──────────────────────────────────────────────── */
+static void pos_to_board(const Pos *p, char bd[SIZE][SIZE])
+{
+    for (int sq = 0; sq < NSQ; ++sq)
+        bd[sq / SIZE][sq % SIZE] = (p->bb[RED]  & BB_SQ(sq)) ? 'R'
+                                 : (p->bb[BLUE] & BB_SQ(sq)) ? 'B' : '.';
+}
+
+static int generate(Engine *e, Sample *out, int max)
+{
+    int n = 0, games = 0;
+    time_t t0 = time(NULL);
+    while (n < max) {
+        Pos p = { 0 };
+        p.bb[RED]  = BB_SQ(0) | BB_SQ(NSQ - 1);
+        p.bb[BLUE] = BB_SQ(SIZE - 1) | BB_SQ(NSQ - SIZE);
+        int side = RED;
+        engine_clear(e);
+        ++games;
+        for (int ply = 0; ply < MAX_PLIES && n < max; ++ply) {
+            if (!p.bb[RED] || !p.bb[BLUE]) break;       // 전멸: 게임 끝
+            Move mv[MAX_MOVES];
+            int cnt = gen_moves(&p, side, mv);
+            if (cnt == 0) {
+                if (!has_moves(&p, side ^ 1)) break;    // 게임 끝
+                side ^= 1;
+                continue;
+            }
+            char bd[SIZE][SIZE];
+            EngineResult res;
+            pos_to_board(&p, bd);
+            engine_search(e, bd, side == RED ? 'R' : 'B', INFINITY, &res);
+            if (ply >= SKIP_PLIES) {
+                int s = res.score;
+                if (s >  SCORE_CLAMP) s =  SCORE_CLAMP;
+                if (s < -SCORE_CLAMP) s = -SCORE_CLAMP;
+                out[n++] = (Sample){ p.bb[side], p.bb[side ^ 1], s };
+            }
+
+            int from, to;
+            if ((int)(rng_next() % 100) < RANDOM_PCT || res.move.r1 < 0) {
+                Move *m = &mv[rng_next() % cnt];
+                from = m->from;
+                to = m->to;
+            } else {
+                from = res.move.r1 * SIZE + res.move.c1;
+                to   = res.move.r2 * SIZE + res.move.c2;
+            }
+            Undo u;
+            make_move(&p, side, from, to, &u);
+            side ^= 1;
+        }
+        if (games % 50 == 0)
+            fprintf(stderr, "[Train] %d games, %d positions, %lds\n",
+                    games, n, (long)(time(NULL) - t0));
+    }
+    return n;
+}
+
+static int load_data(const char *path, Sample **out)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return -1;
+    fseek(fp, 0, SEEK_END);
+    long bytes = ftell(fp);
+    rewind(fp);
+    int n = (int)(bytes / sizeof(Sample));
+    *out = malloc(n * sizeof(Sample));
+    if (!*out || fread(*out, sizeof(Sample), n, fp) != (size_t)n) {
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+    return n;
+}
+
+static void save_data(const char *path, const Sample *s, int n)
+{
+    FILE *fp = fopen(path, "wb");
+    if (!fp || fwrite(s, sizeof(Sample), n, fp) != (size_t)n)
+        perror("[Train] save data");
+    if (fp) fclose(fp);
+}
+
+/* ───── float 모델 ───────────────────────────────────────────────── */
+typedef struct {
+    float w1[NIN][H];
+    float b1[H];
+    float w2[2 * H];
+    float b2;
+} Model;
+
+#define NPARAM ((int)(sizeof(Model) / sizeof(float)))
+
+/* 관점별 은닉층 입력: a = 둘 차례, b = 상대 */
+static float forward(const Model *m, const Sample *s, float za[H], float zb[H])
+{
+    memcpy(za, m->b1, sizeof(m->b1));
+    memcpy(zb, m->b1, sizeof(m->b1));
+    for (bb_t b = s->own; b; ) {
+        int sq = bb_pop(&b);
+        for (int j = 0; j < H; ++j) { za[j] += m->w1[sq][j]; zb[j] += m->w1[NSQ + sq][j]; }
+    }
+    for (bb_t b = s->opp; b; ) {
+        int sq = bb_pop(&b);
+        for (int j = 0; j < H; ++j) { za[j] += m->w1[NSQ + sq][j]; zb[j] += m->w1[sq][j]; }
+    }
+    float y = m->b2;
+    for (int j = 0; j < H; ++j) {
+        float ha = za[j] < 0 ? 0 : za[j] > 1 ? 1 : za[j];
+        float hb = zb[j] < 0 ? 0 : zb[j] > 1 ? 1 : zb[j];
+        y += m->w2[j] * ha + m->w2[H + j] * hb;
+    }
+    return y;       // 말 단위 (평가값 / 100)
+}
+
+/* 오차 g = dL/dy 를 받아 grad 에 더한다 */
+static void backward(const Model *m, const Sample *s, const float za[H],
+                     const float zb[H], float g, Model *grad)
+{
+    float ga[H], gb[H];
+    grad->b2 += g;
+    for (int j = 0; j < H; ++j) {
+        int in_a = za[j] > 0 && za[j] < 1, in_b = zb[j] > 0 && zb[j] < 1;
+        grad->w2[j]     += g * (za[j] < 0 ? 0 : za[j] > 1 ? 1 : za[j]);
+        grad->w2[H + j] += g * (zb[j] < 0 ? 0 : zb[j] > 1 ? 1 : zb[j]);
+        ga[j] = in_a ? g * m->w2[j] : 0;
+        gb[j] = in_b ? g * m->w2[H + j] : 0;
+        grad->b1[j] += ga[j] + gb[j];
+    }
+    for (bb_t b = s->own; b; ) {
+        int sq = bb_pop(&b);
+        for (int j = 0; j < H; ++j) { grad->w1[sq][j] += ga[j]; grad->w1[NSQ + sq][j] += gb[j]; }
+    }
+    for (bb_t b = s->opp; b; ) {
+        int sq = bb_pop(&b);
+        for (int j = 0; j < H; ++j) { grad->w1[NSQ + sq][j] += ga[j]; grad->w1[sq][j] += gb[j]; }
+    }
+}
+
+static void model_init(Model *m)
+{
+    for (int i = 0; i < NIN; ++i)
+        for (int j = 0; j < H; ++j)
+            m->w1[i][j] = rng_uniform(-0.1f, 0.1f);
+    for (int j = 0; j < H; ++j) m->b1[j] = 0.5f;
+    for (int j = 0; j < 2 * H; ++j) m->w2[j] = rng_uniform(-0.5f, 0.5f);
+    m->b2 = 0;
+}
+
+static void model_clip(Model *m)
+{
+    float *p = &m->w1[0][0];
+    for (int i = 0; i < NIN * H + H; ++i)           // w1, b1
+        p[i] = fmaxf(-W1_MAX, fminf(W1_MAX, p[i]));
+    for (int j = 0; j < 2 * H; ++j)
+        m->w2[j] = fmaxf(-W2_MAX, fminf(W2_MAX, m->w2[j]));
+}
+
+/* 검증 국면의 RMSE (평가 단위) */
+static double rmse_float(const Model *m, const Sample *s, int n)
+{
+    double se = 0;
+    float za[H], zb[H];
+    for (int i = 0; i < n; ++i) {
+        double d = forward(m, &s[i], za, zb) * 100 - s[i].score;
+        se += d * d;
+    }
+    return n ? sqrt(se / n) : 0;
+}
+
+static double rmse_quant(const NNWeights *nn, const Sample *s, int n)
+{
+    double se = 0;
+    for (int i = 0; i < n; ++i) {
+        Pos p = { .bb = { s[i].own, s[i].opp } };
+        NNAccum acc;
+        nn_refresh(nn, &p, &acc);
+        double d = nn_output(nn, &acc, RED) - s[i].score;
+        se += d * d;
+    }
+    return n ? sqrt(se / n) : 0;
+}
+
+static double rmse_classic(const Sample *s, int n)
+{
+    double se = 0;
+    for (int i = 0; i < n; ++i) {
+        Pos p = { .bb = { s[i].own, s[i].opp } };
+        double d = evaluate_board(&p, RED) - s[i].score;
+        se += d * d;
+    }
+    return n ? sqrt(se / n) : 0;
+}
+
+static void quantize(const Model *m, NNWeights *nn)
+{
+    for (int i = 0; i < NIN; ++i)
+        for (int j = 0; j < H; ++j)
+            nn->w1[i][j] = (int16_t)lrintf(m->w1[i][j] * NN_QA);
+    for (int j = 0; j < H; ++j) nn->b1[j] = (int16_t)lrintf(m->b1[j] * NN_QA);
+    for (int j = 0; j < 2 * H; ++j) nn->w2[j] = (int16_t)lrintf(m->w2[j] * 100 * NN_QB);
+    nn->b2 = (int32_t)lrint((double)m->b2 * 100 * NN_QA * NN_QB);
+    for (int sq = 0; sq < NSQ; ++sq)
+        for (int j = 0; j < H; ++j)
+            nn->wflip[sq][j] = nn->w1[sq][j] - nn->w1[NSQ + sq][j];
+}
+
+static void train(Model *m, Sample *s, int ntrain, const Sample *valid, int nvalid,
+                  int epochs, float lr)
+{
+    static Model grad, adam_m, adam_v;
+    const float beta1 = 0.9f, beta2 = 0.999f, eps = 1e-8f;
+    float *pm = (float *)m, *pg = (float *)&grad;
+    float *am = (float *)&adam_m, *av = (float *)&adam_v;
+    long step = 0;
+    float za[H], zb[H];
+
+    for (int ep = 1; ep <= epochs; ++ep) {
+        // 매 epoch 섞는다
+        for (int i = ntrain - 1; i > 0; --i) {
+            int j = (int)(rng_next() % (i + 1));
+            Sample t = s[i]; s[i] = s[j]; s[j] = t;
+        }
+        // 마지막 1/4 은 학습률을 줄여 마무리
+        float rate = ep > epochs * 3 / 4 ? lr * 0.1f : lr;
+        double se = 0;
+        for (int b0 = 0; b0 < ntrain; b0 += BATCH) {
+            int bn = ntrain - b0 < BATCH ? ntrain - b0 : BATCH;
+            memset(&grad, 0, sizeof(grad));
+            for (int i = b0; i < b0 + bn; ++i) {
+                float d = forward(m, &s[i], za, zb) - s[i].score / 100.0f;
+                se += (double)d * d;
+                backward(m, &s[i], za, zb, 2 * d / bn, &grad);
+            }
+            ++step;
+            float c1 = 1 - powf(beta1, step), c2 = 1 - powf(beta2, step);
+            for (int k = 0; k < NPARAM; ++k) {
+                am[k] = beta1 * am[k] + (1 - beta1) * pg[k];
+                av[k] = beta2 * av[k] + (1 - beta2) * pg[k] * pg[k];
+                pm[k] -= rate * (am[k] / c1) / (sqrtf(av[k] / c2) + eps);
+            }
+            model_clip(m);
+        }
+        fprintf(stderr, "[Train] epoch %2d  train rmse %.1f  valid rmse %.1f\n",
+                ep, sqrt(se / ntrain) * 100, rmse_float(m, valid, nvalid));
+    }
+}
+
+/* =================================================================
+*                              main
+* =================================================================*/
+static void train_usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-positions <N>] [-depth <D>] [-label <weights>] [-data <file>]\n"
+            "       [-epochs <E>] [-lr <rate>] [-seed <S>] -o <weights>\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    int positions = 100000, depth = 4, epochs = 30;
+    float lr = 0.002f;
+    const char *out = NULL, *data = NULL;
+    EngineConfig cfg = ENGINE_CONFIG_DEFAULT;
+    cfg.hash_mb = 16;
+    cfg.endgame_empties = 0;    // 라벨은 모두 평가 단위로
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-positions") == 0) {
+            positions = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-depth") == 0) {
+            depth = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-label") == 0) {
+            cfg.eval_file = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-data") == 0) {
+            data = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-epochs") == 0) {
+            epochs = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-lr") == 0) {
+            lr = (float)atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-seed") == 0) {
+            rng_state ^= strtoull(argv[++i], NULL, 10) * 0x9E3779B97F4A7C15ULL;
+        } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+            out = argv[++i];
+        } else {
+            train_usage(argv[0]);
+        }
+    }
+    if (!out || positions < 100 || depth < 1 || depth >= MAX_PLY || epochs < 1)
+        train_usage(argv[0]);
+    init_bitboards();
+
+    // (1)(2) 국면 + 라벨
+    Sample *samples = NULL;
+    int n = data ? load_data(data, &samples) : -1;
+    if (n > 0) {
+        fprintf(stderr, "[Train] %d positions from %s\n", n, data);
+    } else {
+        cfg.max_depth = depth;
+        Engine *e = engine_create(&cfg);
+        samples = malloc(positions * sizeof(Sample));
+        if (!e || !samples) {
+            fprintf(stderr, "[Train] engine init failed\n");
+            return EXIT_FAILURE;
+        }
+        n = generate(e, samples, positions);
+        engine_destroy(e);
+        if (data) save_data(data, samples, n);
+    }
+
+    // (3) 학습: 앞쪽 VALID_PCT% 는 검증용 (대국 단위로 갈리도록 섞기 전에 자른다)
+    int nvalid = n * VALID_PCT / 100;
+    Sample *valid = samples, *trainset = samples + nvalid;
+    static Model model;
+    model_init(&model);
+    train(&model, trainset, n - nvalid, valid, nvalid, epochs, lr);
+
+    void *mem = NULL;
+    if (posix_memalign(&mem, 32, sizeof(NNWeights)) != 0) return EXIT_FAILURE;
+    NNWeights *nn = mem;
+    quantize(&model, nn);
+    printf("valid rmse: float %.1f  quantized %.1f  evaluate_board %.1f  (%d positions, %s)\n",
+           rmse_float(&model, valid, nvalid), rmse_quant(nn, valid, nvalid),
+           rmse_classic(valid, nvalid), nvalid, nn_simd_name());
+    if (nn_save(out, nn) < 0) {
+        perror("[Train] save weights");
+        return EXIT_FAILURE;
+    }
+    printf("saved %s\n", out);
+    return 0;
+}
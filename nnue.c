@@ -0,0 +1,218 @@
+/********************************************************************
+ *  nnue.c ― 양자화 신경망 평가: 가중치 읽기, 누산기 갱신, 출력
+ *
+ *  빌드 (engine.c 와 함께, SIMD 를 쓰려면 -mavx2 또는 -march=native):
+ *      gcc -c nnue.c -O2 -Wall -Wextra -march=native [-DOCTAFLIP_SIZE=N]
+ *******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nnue.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* ───── 벡터 연산: dst = src ± w (NN_HIDDEN 개 int16) ──────────────── */
+static inline void vec_add(int16_t *dst, const int16_t *w)
+{
+#if defined(__AVX2__)
+    for (int i = 0; i < NN_HIDDEN; i += 16) {
+        __m256i a = _mm256_load_si256((const __m256i *)(dst + i));
+        __m256i b = _mm256_load_si256((const __m256i *)(w + i));
+        _mm256_store_si256((__m256i *)(dst + i), _mm256_add_epi16(a, b));
+    }
+#elif defined(__SSE2__)
+    for (int i = 0; i < NN_HIDDEN; i += 8) {
+        __m128i a = _mm_load_si128((const __m128i *)(dst + i));
+        __m128i b = _mm_load_si128((const __m128i *)(w + i));
+        _mm_store_si128((__m128i *)(dst + i), _mm_add_epi16(a, b));
+    }
+#else
+    for (int i = 0; i < NN_HIDDEN; ++i) dst[i] += w[i];
+#endif
+}
+
+static inline void vec_sub(int16_t *dst, const int16_t *w)
+{
+#if defined(__AVX2__)
+    for (int i = 0; i < NN_HIDDEN; i += 16) {
+        __m256i a = _mm256_load_si256((const __m256i *)(dst + i));
+        __m256i b = _mm256_load_si256((const __m256i *)(w + i));
+        _mm256_store_si256((__m256i *)(dst + i), _mm256_sub_epi16(a, b));
+    }
+#elif defined(__SSE2__)
+    for (int i = 0; i < NN_HIDDEN; i += 8) {
+        __m128i a = _mm_load_si128((const __m128i *)(dst + i));
+        __m128i b = _mm_load_si128((const __m128i *)(w + i));
+        _mm_store_si128((__m128i *)(dst + i), _mm_sub_epi16(a, b));
+    }
+#else
+    for (int i = 0; i < NN_HIDDEN; ++i) dst[i] -= w[i];
+#endif
+}
+
+/* Σ clamp(h, 0, QA) * w  (int32) */
+static inline int32_t vec_dot_crelu(const int16_t *h, const int16_t *w)
+{
+#if defined(__AVX2__)
+    __m256i zero = _mm256_setzero_si256(), qa = _mm256_set1_epi16(NN_QA);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < NN_HIDDEN; i += 16) {
+        __m256i x = _mm256_load_si256((const __m256i *)(h + i));
+        x = _mm256_min_epi16(_mm256_max_epi16(x, zero), qa);
+        __m256i y = _mm256_load_si256((const __m256i *)(w + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(x, y));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+#elif defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128(), qa = _mm_set1_epi16(NN_QA);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < NN_HIDDEN; i += 8) {
+        __m128i x = _mm_load_si128((const __m128i *)(h + i));
+        x = _mm_min_epi16(_mm_max_epi16(x, zero), qa);
+        __m128i y = _mm_load_si128((const __m128i *)(w + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(x, y));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < NN_HIDDEN; ++i) {
+        int x = h[i] < 0 ? 0 : h[i] > NN_QA ? NN_QA : h[i];
+        sum += x * w[i];
+    }
+    return sum;
+#endif
+}
+
+const char *nn_simd_name(void)
+{
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+/* ───── 누산기 ────────────────────────────────────────────────────── */
+/* 특징 번호: 관점 persp 에서 color 말이 sq 에 있음 */
+static inline int feature(int persp, int color, int sq)
+{
+    return color == persp ? sq : NSQ + sq;
+}
+
+void nn_refresh(const NNWeights *nn, const Pos *p, NNAccum *acc)
+{
+    for (int persp = RED; persp <= BLUE; ++persp) {
+        memcpy(acc->v[persp], nn->b1, sizeof(nn->b1));
+        for (int color = RED; color <= BLUE; ++color)
+            for (bb_t b = p->bb[color]; b; )
+                vec_add(acc->v[persp], nn->w1[feature(persp, color, bb_pop(&b))]);
+    }
+}
+
+void nn_update(const NNWeights *nn, const NNAccum *parent, NNAccum *child,
+               int side, int to, const Undo *u)
+{
+    bb_t from = u->moved & ~BB_SQ(to);      /* 점프면 출발 칸 */
+    for (int persp = RED; persp <= BLUE; ++persp) {
+        int16_t *v = child->v[persp];
+        memcpy(v, parent->v[persp], sizeof(child->v[persp]));
+        vec_add(v, nn->w1[feature(persp, side, to)]);
+        if (from) vec_sub(v, nn->w1[feature(persp, side, bb_lsb(from))]);
+        // 뒤집힌 칸: 상대 말 → side 말.  두 특징의 차이는 미리 구해 둔 wflip
+        for (bb_t f = u->flips; f; ) {
+            int sq = bb_pop(&f);
+            if (persp == side) vec_add(v, nn->wflip[sq]);
+            else               vec_sub(v, nn->wflip[sq]);
+        }
+    }
+}
+
+int nn_output(const NNWeights *nn, const NNAccum *acc, int side)
+{
+    int32_t sum = nn->b2
+                + vec_dot_crelu(acc->v[side],     nn->w2)
+                + vec_dot_crelu(acc->v[side ^ 1], nn->w2 + NN_HIDDEN);
+    return sum / (NN_QA * NN_QB);
+}
+
+/* ───── 파일 ──────────────────────────────────────────────────────── */
+NNWeights *nn_load(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        perror("[NNUE] open weights");
+        return NULL;
+    }
+    NNHeader h;
+    NNWeights *nn = NULL;
+    if (fread(&h, sizeof(h), 1, fp) != 1 || h.magic != NN_MAGIC) {
+        fprintf(stderr, "[NNUE] %s: not a weights file\n", path);
+    } else if (h.version != NN_VERSION || h.size != SIZE || h.hidden != NN_HIDDEN) {
+        fprintf(stderr, "[NNUE] %s: version %u size %u hidden %u, need %d/%d/%d\n",
+                path, h.version, h.size, h.hidden, NN_VERSION, SIZE, NN_HIDDEN);
+    } else {
+        void *mem = NULL;
+        if (posix_memalign(&mem, 32, sizeof(NNWeights)) == 0) {
+            nn = mem;
+            if (fread(nn->w1, sizeof(nn->w1), 1, fp) != 1
+                || fread(nn->b1, sizeof(nn->b1), 1, fp) != 1
+                || fread(nn->w2, sizeof(nn->w2), 1, fp) != 1
+                || fread(&nn->b2, sizeof(nn->b2), 1, fp) != 1) {
+                fprintf(stderr, "[NNUE] %s: truncated\n", path);
+                free(nn);
+                nn = NULL;
+            } else {
+                for (int sq = 0; sq < NSQ; ++sq)
+                    for (int i = 0; i < NN_HIDDEN; ++i)
+                        nn->wflip[sq][i] = nn->w1[sq][i] - nn->w1[NSQ + sq][i];
+            }
+        }
+    }
+    fclose(fp);
+    return nn;
+}
+
+int nn_save(const char *path, const NNWeights *nn)
+{
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        perror("[NNUE] open weights");
+        return -1;
+    }
+    NNHeader h = { NN_MAGIC, NN_VERSION, SIZE, NN_HIDDEN };
+    int ok = fwrite(&h, sizeof(h), 1, fp) == 1
+          && fwrite(nn->w1, sizeof(nn->w1), 1, fp) == 1
+          && fwrite(nn->b1, sizeof(nn->b1), 1, fp) == 1
+          && fwrite(nn->w2, sizeof(nn->w2), 1, fp) == 1
+          && fwrite(&nn->b2, sizeof(nn->b2), 1, fp) == 1;
+    if (fclose(fp) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+void nn_free(NNWeights *nn) { free(nn); }
+
+uint64_t nn_hash(const NNWeights *nn)
+{
+    // FNV-1a: 파일에 쓰는 부분만 (wflip 은 w1 에서 나온다)
+    uint64_t h = 0xCBF29CE484222325ULL;
+    const void *part[4] = { nn->w1, nn->b1, nn->w2, &nn->b2 };
+    size_t len[4] = { sizeof(nn->w1), sizeof(nn->b1), sizeof(nn->w2), sizeof(nn->b2) };
+    for (int i = 0; i < 4; ++i)
+        for (size_t k = 0; k < len[i]; ++k)
+            h = (h ^ ((const uint8_t *)part[i])[k]) * 0x100000001B3ULL;
+    return h;
+}
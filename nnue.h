@@ -0,0 +1,76 @@
+/********************************************************************
+ *  nnue.h ― 작은 양자화 신경망 평가 (NNUE 방식)
+ *
+ *  입력: 칸마다 "둘 차례 말 / 상대 말" 두 가지 특징 (2 * NSQ 개)
+ *  구조: 2*NSQ → NN_HIDDEN (양쪽 관점 각각, 가중치 공유) → 1
+ *
+ *      z_p = b1 + Σ W1[특징]          관점 p ∈ {RED, BLUE} 의 누산기 (int16)
+ *      h_p = clamp(z_p, 0, NN_QA)
+ *      out = (b2 + w2[0..H) · h_둘차례 + w2[H..2H) · h_상대) / (NN_QA * NN_QB)
+ *
+ *  결과 단위는 evaluate_board 와 같다 (말 하나 = 100).
+ *  누산기는 make_move 때 바뀐 칸(놓은 칸, 점프 출발 칸, 뒤집힌 칸)만큼만
+ *  더하고 빼며, 되돌릴 때는 ply 별로 쌓아 둔 이전 누산기를 그대로 쓴다.
+ *  AVX2 → SSE2 → 스칼라 순으로 컴파일 때 고른다 (-mavx2 / -march=native).
+ *
+ *  가중치 파일 (little endian):
+ *      NNHeader { magic "OFNN", version, size, hidden }
+ *      int16 w1[2 * NSQ][NN_HIDDEN]     특징 i = 둘 차례 말 sq / 상대 말 NSQ + sq
+ *      int16 b1[NN_HIDDEN]
+ *      int16 w2[2 * NN_HIDDEN]
+ *      int32 b2
+ *  nn_train.c 가 만든다.  |w1| 은 (NSQ + 1) 개를 더해도 int16 을 넘지 않게,
+ *  |w1[sq] - w1[NSQ + sq]| 도 int16 안에 들도록 잘라 둔다.
+ *******************************************************************/
+#ifndef OCTAFLIP_NNUE_H
+#define OCTAFLIP_NNUE_H
+
+#include <stdint.h>
+#include "engine.h"
+
+#define NN_MAGIC    0x4E4E464FU         /* "OFNN" */
+#define NN_VERSION  1
+#define NN_HIDDEN   32
+#define NN_QA       127                 /* 은닉층 활성값 1.0 = NN_QA */
+#define NN_QB       32                  /* 출력 가중치 1.0 (평가 단위, 말 하나 = 100) = NN_QB */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                      /* 보드 한 변 (OCTAFLIP_SIZE 와 같아야 함) */
+    uint32_t hidden;                    /* NN_HIDDEN 과 같아야 함 */
+} NNHeader;
+
+typedef struct {
+    _Alignas(32) int16_t w1[2 * NSQ][NN_HIDDEN];
+    _Alignas(32) int16_t b1[NN_HIDDEN];
+    _Alignas(32) int16_t w2[2 * NN_HIDDEN];
+    int32_t b2;
+    _Alignas(32) int16_t wflip[NSQ][NN_HIDDEN];     /* w1[sq] - w1[NSQ + sq], 읽을 때 계산 */
+} NNWeights;
+
+/* 관점별 누산기: v[RED] 는 RED 를 "둘 차례" 로 본 z, v[BLUE] 는 반대 */
+typedef struct {
+    _Alignas(32) int16_t v[2][NN_HIDDEN];
+} NNAccum;
+
+/* 가중치 파일을 읽는다.  실패하면 이유를 출력하고 NULL */
+NNWeights *nn_load(const char *path);
+/* 양자화된 가중치를 파일로 (nn_train 용).  실패하면 -1 */
+int nn_save(const char *path, const NNWeights *nn);
+void nn_free(NNWeights *nn);
+/* 가중치 내용의 64비트 해시 (같은 파일이면 같은 값, 디스크 캐시 tag 용) */
+uint64_t nn_hash(const NNWeights *nn);
+
+/* 보드 전체로 누산기를 새로 계산 (루트에서 한 번) */
+void nn_refresh(const NNWeights *nn, const Pos *p, NNAccum *acc);
+/* make_move(p, side, from, to, u) 뒤에 parent → child 갱신 */
+void nn_update(const NNWeights *nn, const NNAccum *parent, NNAccum *child,
+               int side, int to, const Undo *u);
+/* side 관점 평가값 (말 하나 = 100) */
+int nn_output(const NNWeights *nn, const NNAccum *acc, int side);
+
+/* 컴파일된 SIMD 경로 이름 ("avx2", "sse2", "scalar") */
+const char *nn_simd_name(void);
+
+#endif /* OCTAFLIP_NNUE_H */
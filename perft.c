@@ -0,0 +1,475 @@
+/********************************************************************
+ *  perft.c ― 수 생성기 검증 (perft) 과 기준 구현과의 비교 테스트
+ *
+ *  perft: 주어진 국면에서 깊이 N 까지 말단 국면 수를 센다.
+ *    - 같은 칸으로의 복제는 출발 칸과 무관하게 결과가 같으므로 한 수로 센다
+ *    - 둘 수가 없으면 패스(한 수로 침), 양쪽 모두 없거나 한쪽 말이
+ *      전멸하면 게임 끝(말단 1개).  엔진·서버와 같은 규칙
+ *  diff : 무작위 국면에서 엔진의 bitboard 생성기·make/unmake·평가를
+ *         원래의 char 보드 코드(DR/DC 방향 + step 루프)와 비교한다.
+ *         -eval <weights> 를 주면 신경망 누산기의 증분 갱신도
+ *         매 수마다 처음부터 다시 계산한 값과 비교한다.
+ *         대칭 8 가지도 함께 본다: char 보드를 돌린 것과 bb_transform,
+ *         역변환, 색을 바꾼 16 가지 국면의 정규형, 돌린 국면의 perft.
+ *
+ *  빌드:
+ *      gcc perft.c engine.c nnue.c book.c cache.c -o perft -O2 -Wall -Wextra -lm -pthread
+ *
+ *  실행 예:
+ *      ./perft -depth 5                    (시작 국면)
+ *      ./perft -depth 4 -ref -divide -pos R......B/......../......../......../......../......../......../B......R R
+ *      ./perft -diff -count 100000 -seed 7
+ *      ./perft -diff -eval octaflip.nn
+ *******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "engine.h"
+#include "nnue.h"
+
+/* =================================================================
+*             기준 구현: 원래 클라이언트의 char 보드 코드
+* =================================================================*/
+static const int DR[8] = { -1,-1,-1, 0, 0, 1, 1, 1 };
+static const int DC[8] = { -1, 0, 1,-1, 1,-1, 0, 1 };
+
+typedef struct { int r1, c1, r2, c2; } RefMove;
+
+static inline int in_bounds(int r, int c)
+{
+    return r >= 0 && r < SIZE && c >= 0 && c < SIZE;
+}
+
+static void ref_apply(char bd[SIZE][SIZE], const RefMove *m, char me)
+{
+    char opp = (me == 'R') ? 'B' : 'R';
+    if (abs(m->r2 - m->r1) == 2 || abs(m->c2 - m->c1) == 2)
+        bd[m->r1][m->c1] = '.';
+    bd[m->r2][m->c2] = me;
+    for (int d = 0; d < 8; ++d) {
+        int nr = m->r2 + DR[d], nc = m->c2 + DC[d];
+        if (in_bounds(nr, nc) && bd[nr][nc] == opp)
+            bd[nr][nc] = me;
+    }
+}
+
+/* 같은 칸으로의 복제는 첫 번째 것만 남긴다 */
+static int ref_gen_moves(char bd[SIZE][SIZE], char me, RefMove *mv)
+{
+    int n = 0;
+    char cloned[SIZE][SIZE] = {{0}};
+    for (int r = 0; r < SIZE; ++r)
+        for (int c = 0; c < SIZE; ++c) {
+            if (bd[r][c] != me) continue;
+            for (int d = 0; d < 8; ++d) {
+                int nr = r + DR[d], nc = c + DC[d];
+                for (int step = 1; step <= 2;
+                     ++step, nr += DR[d], nc += DC[d]) {
+                    if (!in_bounds(nr, nc)) break;
+                    if (bd[nr][nc] != '.') continue;
+                    if (step == 1) {
+                        if (cloned[nr][nc]) continue;
+                        cloned[nr][nc] = 1;
+                    }
+                    mv[n++] = (RefMove){ r, c, nr, nc };
+                }
+            }
+        }
+    return n;
+}
+
+static int ref_mobility(char bd[SIZE][SIZE], char me)
+{
+    int cnt = 0;
+    for (int r = 0; r < SIZE; ++r)
+        for (int c = 0; c < SIZE; ++c) {
+            if (bd[r][c] != me) continue;
+            for (int d = 0; d < 8; ++d) {
+                int nr = r + DR[d], nc = c + DC[d];
+                for (int step = 1; step <= 2;
+                     ++step, nr += DR[d], nc += DC[d]) {
+                    if (in_bounds(nr, nc) && bd[nr][nc] == '.') {
+                        ++cnt;
+                        goto NEXT_PIECE;
+                    }
+                }
+            }
+        NEXT_PIECE:;
+        }
+    return cnt;
+}
+
+static int ref_evaluate(char bd[SIZE][SIZE], char me)
+{
+    char opp = (me == 'R') ? 'B' : 'R';
+    int my = 0, op = 0;
+    for (int r = 0; r < SIZE; ++r)
+        for (int c = 0; c < SIZE; ++c) {
+            if      (bd[r][c] == me)  ++my;
+            else if (bd[r][c] == opp) ++op;
+        }
+    return (my - op) * 100 + (ref_mobility(bd, me) - ref_mobility(bd, opp)) * 10;
+}
+
+static uint64_t ref_perft(char bd[SIZE][SIZE], char me, int depth)
+{
+    if (depth == 0) return 1;
+    char opp = (me == 'R') ? 'B' : 'R';
+    int mine = 0, theirs = 0;
+    for (int r = 0; r < SIZE; ++r)
+        for (int c = 0; c < SIZE; ++c) {
+            mine   += bd[r][c] == me;
+            theirs += bd[r][c] == opp;
+        }
+    if (!mine || !theirs) return 1;                      /* 전멸: 게임 끝 */
+    RefMove mv[MAX_MOVES];
+    int n = ref_gen_moves(bd, me, mv);
+    if (n == 0) {
+        RefMove tmp[MAX_MOVES];
+        if (ref_gen_moves(bd, opp, tmp) == 0) return 1;  /* 게임 끝 */
+        return ref_perft(bd, opp, depth - 1);            /* 패스 */
+    }
+    uint64_t total = 0;
+    for (int i = 0; i < n; ++i) {
+        char sim[SIZE][SIZE];
+        memcpy(sim, bd, sizeof(sim));
+        ref_apply(sim, &mv[i], me);
+        total += ref_perft(sim, opp, depth - 1);
+    }
+    return total;
+}
+
+/* =================================================================
+*                  bitboard perft (make/unmake)
+* =================================================================*/
+static Undo perft_undo[MAX_PLY];
+
+static uint64_t perft(Pos *p, int side, int ply, int depth)
+{
+    if (depth == 0) return 1;
+    if (!p->bb[side] || !p->bb[side ^ 1]) return 1;     // 전멸: 게임 끝
+    Move mv[MAX_MOVES];
+    int n = gen_moves(p, side, mv);
+    if (n == 0) {
+        if (!has_moves(p, side ^ 1)) return 1;
+        return perft(p, side ^ 1, ply + 1, depth - 1);
+    }
+    if (depth == 1) return n;
+    uint64_t total = 0;
+    for (int i = 0; i < n; ++i) {
+        make_move(p, side, mv[i].from, mv[i].to, &perft_undo[ply]);
+        total += perft(p, side ^ 1, ply + 1, depth - 1);
+        unmake_move(p, side, &perft_undo[ply]);
+    }
+    return total;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* 루트 수마다 말단 수 (수 생성기 버그 위치를 좁힐 때) */
+static void perft_divide(char bd[SIZE][SIZE], char me, int depth)
+{
+    Pos p;
+    board_to_pos(bd, &p);
+    int side = color_index(me);
+    Move mv[MAX_MOVES];
+    int n = gen_moves(&p, side, mv);
+    for (int i = 0; i < n; ++i) {
+        Undo u;
+        make_move(&p, side, mv[i].from, mv[i].to, &u);
+        uint64_t cnt = perft(&p, side ^ 1, 1, depth - 1);
+        unmake_move(&p, side, &u);
+        printf("  (%d,%d)->(%d,%d) %llu\n",
+               mv[i].from / SIZE + 1, mv[i].from % SIZE + 1,
+               mv[i].to / SIZE + 1, mv[i].to % SIZE + 1,
+               (unsigned long long)cnt);
+    }
+}
+
+static int run_perft(char bd[SIZE][SIZE], char me, int max_depth, int ref, int divide)
+{
+    Pos p;
+    board_to_pos(bd, &p);
+    int side = color_index(me);
+    int ok = 1;
+    for (int d = 1; d <= max_depth; ++d) {
+        double t0 = now_sec();
+        uint64_t cnt = perft(&p, side, 0, d);
+        double t = now_sec() - t0;
+        printf("perft %2d %14llu  %8.3f s %10.0f kpos/s\n", d,
+               (unsigned long long)cnt, t, t > 0 ? cnt / t / 1000 : 0);
+        if (ref) {
+            t0 = now_sec();
+            uint64_t rcnt = ref_perft(bd, me, d);
+            t = now_sec() - t0;
+            printf("  ref %2d %14llu  %8.3f s %10.0f kpos/s%s\n", d,
+                   (unsigned long long)rcnt, t, t > 0 ? rcnt / t / 1000 : 0,
+                   rcnt == cnt ? "" : "  MISMATCH");
+            if (rcnt != cnt) ok = 0;
+        }
+    }
+    if (divide) perft_divide(bd, me, max_depth);
+    return ok;
+}
+
+/* =================================================================
+*             diff: 무작위 국면에서 기준 구현과 비교
+* =================================================================*/
+typedef struct { bb_t red, blue; } PosKey;
+
+static int cmp_poskey(const void *a, const void *b)
+{
+    const PosKey *x = a, *y = b;
+    if (x->red  != y->red)  return x->red  < y->red  ? -1 : 1;
+    if (x->blue != y->blue) return x->blue < y->blue ? -1 : 1;
+    return 0;
+}
+
+static uint64_t full_key(const Pos *p)
+{
+    uint64_t k = 0;
+    for (int side = RED; side <= BLUE; ++side)
+        for (bb_t b = p->bb[side]; b; )
+            k ^= ZOB[side][bb_pop(&b)];
+    return k;
+}
+
+static void print_board(char bd[SIZE][SIZE], char me)
+{
+    for (int r = 0; r < SIZE; ++r) {
+        fwrite(bd[r], 1, SIZE, stdout);
+        putchar(r < SIZE - 1 ? '/' : ' ');
+    }
+    printf("%c\n", me);
+}
+
+static NNWeights *diff_nn;         /* -eval: 누산기 증분 갱신도 비교 */
+
+/* 대칭 변환·정규형 검사.  p 는 bd 를 읽은 국면 */
+static int diff_symmetry(char bd[SIZE][SIZE], char me, const Pos *p, int perft_depth)
+{
+    int side = color_index(me);
+    Pos canon;
+    pos_canonical(p, side, &canon);
+    for (int sym = 0; sym < SYM_COUNT; ++sym) {
+        char tb[SIZE][SIZE], sw[SIZE][SIZE];
+        for (int sq = 0; sq < NSQ; ++sq) {
+            int t = sq_transform(sq, sym);
+            char ch = bd[sq / SIZE][sq % SIZE];
+            tb[t / SIZE][t % SIZE] = ch;
+            sw[t / SIZE][t % SIZE] = ch == 'R' ? 'B' : ch == 'B' ? 'R' : ch;
+        }
+        Pos want, got, back, c1, c2;
+        board_to_pos(tb, &want);
+        pos_transform(p, sym, &got);
+        if (memcmp(&want, &got, sizeof(Pos)) != 0) {
+            printf("[Diff] bb_transform sym %d\n", sym);
+            return 0;
+        }
+        pos_transform(&got, sym_inverse(sym), &back);
+        if (memcmp(&back, p, sizeof(Pos)) != 0) {
+            printf("[Diff] sym_inverse(%d) = %d does not restore\n", sym, sym_inverse(sym));
+            return 0;
+        }
+        pos_canonical(&want, side, &c1);
+        board_to_pos(sw, &want);
+        pos_canonical(&want, side ^ 1, &c2);
+        if (memcmp(&c1, &canon, sizeof(Pos)) != 0 || memcmp(&c2, &canon, sizeof(Pos)) != 0) {
+            printf("[Diff] canonical form differs under sym %d%s\n", sym,
+                   memcmp(&c1, &canon, sizeof(Pos)) == 0 ? " + color swap" : "");
+            return 0;
+        }
+    }
+    if (perft_depth > 0) {
+        Pos q = *p, t;
+        int sym = 1 + (int)(p->key % (SYM_COUNT - 1));
+        pos_transform(&q, sym, &t);
+        uint64_t a = perft(&q, side, 0, perft_depth), b = perft(&t, side, 0, perft_depth);
+        if (a != b) {
+            printf("[Diff] perft %d: %llu, sym %d %llu\n", perft_depth,
+                   (unsigned long long)a, sym, (unsigned long long)b);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* 한 국면 비교. 다르면 무엇이 다른지 출력하고 0 */
+static int diff_position(char bd[SIZE][SIZE], char me, int perft_depth)
+{
+    Pos p;
+    board_to_pos(bd, &p);
+    int side = color_index(me);
+
+    if (evaluate_board(&p, side) != ref_evaluate(bd, me)) {
+        printf("[Diff] evaluate %d != ref %d\n",
+               evaluate_board(&p, side), ref_evaluate(bd, me));
+        return 0;
+    }
+
+    // 두 생성기가 만드는 "결과 국면" 집합이 같아야 한다
+    static RefMove rmv[MAX_MOVES];
+    static PosKey  want[MAX_MOVES], got[MAX_MOVES];
+    int rn = ref_gen_moves(bd, me, rmv);
+    for (int i = 0; i < rn; ++i) {
+        char sim[SIZE][SIZE];
+        Pos q;
+        memcpy(sim, bd, sizeof(sim));
+        ref_apply(sim, &rmv[i], me);
+        board_to_pos(sim, &q);
+        want[i] = (PosKey){ q.bb[RED], q.bb[BLUE] };
+    }
+
+    Move mv[MAX_MOVES];
+    board_to_pos(bd, &p);
+    int n = gen_moves(&p, side, mv);
+    if (n != rn || (n > 0) != has_moves(&p, side)) {
+        printf("[Diff] %d moves, ref %d, has_moves %d\n", n, rn, has_moves(&p, side));
+        return 0;
+    }
+    NNAccum acc[3];
+    if (diff_nn) nn_refresh(diff_nn, &p, &acc[0]);
+    for (int i = 0; i < n; ++i) {
+        Pos before = p;
+        Undo u;
+        make_move(&p, side, mv[i].from, mv[i].to, &u);
+        if (p.key != full_key(&p)) {
+            printf("[Diff] incremental key after (%d)->(%d)\n", mv[i].from, mv[i].to);
+            return 0;
+        }
+        if (diff_nn) {
+            nn_update(diff_nn, &acc[0], &acc[1], side, mv[i].to, &u);
+            nn_refresh(diff_nn, &p, &acc[2]);
+            if (memcmp(&acc[1], &acc[2], sizeof(NNAccum)) != 0) {
+                printf("[Diff] incremental accumulator after (%d)->(%d)\n",
+                       mv[i].from, mv[i].to);
+                return 0;
+            }
+        }
+        got[i] = (PosKey){ p.bb[RED], p.bb[BLUE] };
+        unmake_move(&p, side, &u);
+        if (memcmp(&before, &p, sizeof(p)) != 0) {
+            printf("[Diff] unmake of (%d)->(%d) did not restore\n", mv[i].from, mv[i].to);
+            return 0;
+        }
+    }
+    qsort(want, rn, sizeof(PosKey), cmp_poskey);
+    qsort(got,  n,  sizeof(PosKey), cmp_poskey);
+    if (memcmp(want, got, n * sizeof(PosKey)) != 0) {
+        printf("[Diff] resulting positions differ\n");
+        return 0;
+    }
+
+    if (!diff_symmetry(bd, me, &p, perft_depth)) return 0;
+
+    if (perft_depth > 0) {
+        uint64_t a = perft(&p, side, 0, perft_depth);
+        uint64_t b = ref_perft(bd, me, perft_depth);
+        if (a != b) {
+            printf("[Diff] perft %d: %llu, ref %llu\n", perft_depth,
+                   (unsigned long long)a, (unsigned long long)b);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int run_diff(long count, unsigned seed)
+{
+    srand(seed);
+    long moves = 0;
+    for (long it = 0; it < count; ++it) {
+        // 빈칸 비율을 국면마다 바꿔 초반~종반을 고루 만든다
+        int empty_pct = rand() % 90 + 5;
+        int block_pct = rand() % 8;
+        char bd[SIZE][SIZE];
+        for (int r = 0; r < SIZE; ++r)
+            for (int c = 0; c < SIZE; ++c) {
+                int x = rand() % 100;
+                bd[r][c] = x < empty_pct             ? '.'
+                         : x < empty_pct + block_pct ? '#'
+                         : (rand() & 1)              ? 'R' : 'B';
+            }
+        char me = (rand() & 1) ? 'R' : 'B';
+        int perft_depth = (it % 64 == 0) ? 3 : (it % 8 == 0) ? 2 : 0;
+        if (!diff_position(bd, me, perft_depth)) {
+            printf("[Diff] FAILED at #%ld (seed %u): ", it, seed);
+            print_board(bd, me);
+            return 0;
+        }
+        RefMove tmp[MAX_MOVES];
+        moves += ref_gen_moves(bd, me, tmp);
+    }
+    printf("[Diff] ok: %ld positions, %ld moves\n", count, moves);
+    return 1;
+}
+
+/* =================================================================
+*                              main
+* =================================================================*/
+static void perft_usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-depth <N>] [-ref] [-divide] [-pos <board> <R|B>]\n"
+            "       %s -diff [-count <N>] [-seed <S>] [-eval <weights>]\n", prog, prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    int depth = 5, ref = 0, divide = 0, diff = 0;
+    long count = 10000;
+    unsigned seed = 1;
+    char bd[SIZE][SIZE];
+    char me = 'R';
+
+    // 기본 국면: 네 귀퉁이
+    memset(bd, '.', sizeof(bd));
+    bd[0][0] = bd[SIZE-1][SIZE-1] = 'R';
+    bd[0][SIZE-1] = bd[SIZE-1][0] = 'B';
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-depth") == 0) {
+            depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-ref") == 0) {
+            ref = 1;
+        } else if (strcmp(argv[i], "-divide") == 0) {
+            divide = 1;
+        } else if (strcmp(argv[i], "-diff") == 0) {
+            diff = 1;
+        } else if (i + 1 < argc && strcmp(argv[i], "-count") == 0) {
+            count = atol(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-seed") == 0) {
+            seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-eval") == 0) {
+            if (!(diff_nn = nn_load(argv[++i]))) return EXIT_FAILURE;
+        } else if (i + 2 < argc && strcmp(argv[i], "-pos") == 0) {
+            const char *s = argv[++i];
+            int cells = 0;
+            for (; *s; ++s) {
+                if (*s == '/') continue;
+                if (cells < NSQ) bd[cells / SIZE][cells % SIZE] = *s;
+                ++cells;
+            }
+            me = argv[++i][0];
+            if (cells != NSQ || (me != 'R' && me != 'B')) perft_usage(argv[0]);
+        } else {
+            perft_usage(argv[0]);
+        }
+    }
+    if (depth < 1 || depth >= MAX_PLY) perft_usage(argv[0]);
+
+    init_bitboards();
+    int ok = diff ? run_diff(count, seed) : run_perft(bd, me, depth, ref, divide);
+    return ok ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,495 @@
+/********************************************************************
+ *  server.c ― 로컬 대전 서버 (실제 서버 대용)
+ *
+ *  클라이언트와 같은 줄 단위 JSON 프로토콜을 그대로 쓴다.
+ *      C→S  {"type":"register","username":..}
+ *      S→C  {"type":"register_ack"}
+ *      S→C  {"type":"game_start","first_player":..,"players":[..,..]}
+ *      S→C  {"type":"your_turn","board":[8줄],"timeout":초}
+ *      C→S  {"type":"move","username":..,"sx":..,"sy":..,"tx":..,"ty":..}
+ *                                  (1부터, 패스는 전부 0)
+ *      S→C  {"type":"game_over","scores":{이름:말 수,..},"reason":..}
+ *
+ *  규칙
+ *    - 먼저 둘 쪽이 R, 네 귀퉁이에서 시작 (R: 좌상·우하, B: 우상·좌하)
+ *    - 둘 수가 있는데 패스, 잘못된 수, timeout(+grace) 초과, 연결 끊김은 몰수패
+ *    - 둘 수가 없으면 your_turn 을 보내 패스를 받는다
+ *    - 양쪽 다 둘 수 없거나 한쪽 말이 없어지면(또는 MAX_TURNS) 끝, 말 수로 승패
+ *    - 상대 차례에는 아무 메시지도 보내지 않는다 (pondering 을 끊지 않도록)
+ *
+ *  빌드 (보드 크기는 클라이언트와 같게 -DOCTAFLIP_SIZE=N, 기본 8):
+ *      gcc server.c cJSON.c -o server -O2 -Wall -Wextra -lm
+ *
+ *  실행 예:
+ *      ./server -port 12345 [-timeout 3.0] [-grace 0.5] [-games 10]
+ *               [-open-plies 4] [-seed 1]
+ *******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <time.h>
+#include "cJSON.h"
+
+#ifndef OCTAFLIP_SIZE
+#define OCTAFLIP_SIZE 8
+#endif
+#define SIZE      OCTAFLIP_SIZE
+#define BUF_SIZE  1024
+#define MAX_TURNS 1000          /* 점프만 반복하는 게임을 끊는다 */
+#define REGISTER_TIMEOUT 10.0   /* 접속 후 register 까지 (초) */
+
+static const int DR[8] = { -1,-1,-1, 0, 0, 1, 1, 1 };
+static const int DC[8] = { -1, 0, 1,-1, 1,-1, 0, 1 };
+
+typedef struct {
+    double      timeout;        /* your_turn 에 실어 보내는 값 (초) */
+    double      grace;          /* 네트워크·프로세스 지연 허용분 (초) */
+    int         open_plies;     /* 서버가 무작위로 두고 시작할 수 (양쪽 합) */
+    unsigned    seed;
+    const char *first;          /* 먼저 둘 사용자 이름, NULL 이면 먼저 등록한 쪽 */
+    int         verbose;
+} GameConfig;
+
+typedef struct {
+    char        name[2][32];    /* [0] = R, [1] = B */
+    int         pieces[2];
+    int         moves[2];       /* 실제로 둔 수 (패스 제외) */
+    double      think[2];       /* 생각 시간 합 (초) */
+    int         forfeit;        /* 몰수패한 쪽, 없으면 -1 */
+    const char *reason;
+} GameResult;
+
+/* =================================================================
+*                       시간 / 연결
+* =================================================================*/
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* 연결마다 따로 버퍼를 둔다 (두 클라이언트를 한 스레드에서 읽으므로) */
+typedef struct {
+    int    fd;
+    char   buf[BUF_SIZE];
+    size_t used;
+    char   name[32];
+} Conn;
+
+enum { RECV_OK = 0, RECV_TIMEOUT, RECV_CLOSED };
+
+/* deadline(now_sec 기준)까지 한 줄을 받아 파싱. 깨진 줄은 무시 */
+static cJSON *conn_recv(Conn *c, double deadline, int *status)
+{
+    for (;;) {
+        char *nl = memchr(c->buf, '\n', c->used);
+        if (nl) {
+            *nl = '\0';
+            cJSON *json = nl > c->buf ? cJSON_Parse(c->buf) : NULL;
+            size_t remain = c->used - (nl + 1 - c->buf);
+            memmove(c->buf, nl + 1, remain);
+            c->used = remain;
+            if (json) {
+                *status = RECV_OK;
+                return json;
+            }
+            continue;
+        }
+        if (c->used >= BUF_SIZE - 1) {
+            *status = RECV_CLOSED;
+            return NULL;
+        }
+
+        double left = deadline - now_sec();
+        if (left <= 0) {
+            *status = RECV_TIMEOUT;
+            return NULL;
+        }
+        struct pollfd pfd = { c->fd, POLLIN, 0 };
+        int rc = poll(&pfd, 1, (int)(left * 1000) + 1);
+        if (rc < 0) {
+            *status = RECV_CLOSED;
+            return NULL;
+        }
+        if (rc == 0) continue;
+
+        ssize_t n = recv(c->fd, c->buf + c->used, BUF_SIZE - c->used - 1, 0);
+        if (n <= 0) {
+            *status = RECV_CLOSED;
+            return NULL;
+        }
+        c->used += n;
+    }
+}
+
+/* 줄바꿈까지 한 번에 보낸다 */
+static int conn_send(Conn *c, cJSON *msg)
+{
+    char *out = cJSON_PrintUnformatted(msg);
+    if (!out) return -1;
+    size_t len = strlen(out);
+    char *line = malloc(len + 1);
+    if (!line) {
+        free(out);
+        return -1;
+    }
+    memcpy(line, out, len);
+    line[len] = '\n';
+    ssize_t n = send(c->fd, line, len + 1, MSG_NOSIGNAL);
+    free(line);
+    free(out);
+    return n == (ssize_t)(len + 1) ? 0 : -1;
+}
+
+/* =================================================================
+*                            규칙
+* =================================================================*/
+static inline int in_bounds(int r, int c)
+{
+    return r >= 0 && r < SIZE && c >= 0 && c < SIZE;
+}
+
+static int has_moves(char bd[SIZE][SIZE], char me)
+{
+    for (int r = 0; r < SIZE; ++r)
+        for (int c = 0; c < SIZE; ++c) {
+            if (bd[r][c] != me) continue;
+            for (int d = 0; d < 8; ++d) {
+                int nr = r + DR[d], nc = c + DC[d];
+                for (int step = 1; step <= 2;
+                     ++step, nr += DR[d], nc += DC[d]) {
+                    if (in_bounds(nr, nc) && bd[nr][nc] == '.') return 1;
+                }
+            }
+        }
+    return 0;
+}
+
+/* 8방향으로 한 칸(복제) 또는 두 칸(점프) 이동, 도착 칸은 빈칸 */
+static int is_legal(char bd[SIZE][SIZE], char me, int r1, int c1, int r2, int c2)
+{
+    if (!in_bounds(r1, c1) || !in_bounds(r2, c2)) return 0;
+    if (bd[r1][c1] != me || bd[r2][c2] != '.') return 0;
+    int dr = abs(r2 - r1), dc = abs(c2 - c1);
+    int dist = dr > dc ? dr : dc;
+    if (dist < 1 || dist > 2) return 0;
+    return dr == 0 || dc == 0 || dr == dc;
+}
+
+static void apply_move(char bd[SIZE][SIZE], char me, int r1, int c1, int r2, int c2)
+{
+    char opp = (me == 'R') ? 'B' : 'R';
+    if (abs(r2 - r1) == 2 || abs(c2 - c1) == 2) bd[r1][c1] = '.';
+    bd[r2][c2] = me;
+    for (int d = 0; d < 8; ++d) {
+        int nr = r2 + DR[d], nc = c2 + DC[d];
+        if (in_bounds(nr, nc) && bd[nr][nc] == opp) bd[nr][nc] = me;
+    }
+}
+
+static int count_pieces(char bd[SIZE][SIZE], char me)
+{
+    int n = 0;
+    for (int r = 0; r < SIZE; ++r)
+        for (int c = 0; c < SIZE; ++c)
+            n += bd[r][c] == me;
+    return n;
+}
+
+/* 시작 국면을 다양하게: 양쪽 번갈아 무작위 합법 수 */
+static void random_opening(char bd[SIZE][SIZE], int plies, unsigned seed, int *turn)
+{
+    unsigned state = seed * 2654435761u + 1;
+    for (int i = 0; i < plies; ++i) {
+        char me = *turn ? 'B' : 'R';
+        int cand[SIZE * SIZE * 16][4], n = 0;
+        for (int r = 0; r < SIZE; ++r)
+            for (int c = 0; c < SIZE; ++c) {
+                if (bd[r][c] != me) continue;
+                for (int d = 0; d < 8; ++d)
+                    for (int step = 1; step <= 2; ++step) {
+                        int nr = r + DR[d] * step, nc = c + DC[d] * step;
+                        if (in_bounds(nr, nc) && bd[nr][nc] == '.') {
+                            cand[n][0] = r;  cand[n][1] = c;
+                            cand[n][2] = nr; cand[n][3] = nc;
+                            ++n;
+                        }
+                    }
+            }
+        if (n == 0) break;
+        state = state * 1103515245u + 12345u;
+        int *m = cand[(state >> 8) % n];
+        apply_move(bd, me, m[0], m[1], m[2], m[3]);
+        *turn ^= 1;
+    }
+}
+
+/* =================================================================
+*                          게임 진행
+* =================================================================*/
+static cJSON *board_json(char bd[SIZE][SIZE])
+{
+    cJSON *arr = cJSON_CreateArray();
+    for (int r = 0; r < SIZE; ++r) {
+        char row[SIZE + 1];
+        memcpy(row, bd[r], SIZE);
+        row[SIZE] = '\0';
+        cJSON_AddItemToArray(arr, cJSON_CreateString(row));
+    }
+    return arr;
+}
+
+/* 접속 하나를 받아 register 까지 처리 */
+static int accept_player(int listen_fd, Conn *c)
+{
+    struct pollfd pfd = { listen_fd, POLLIN, 0 };
+    if (poll(&pfd, 1, (int)(REGISTER_TIMEOUT * 1000)) <= 0) {
+        fprintf(stderr, "[Server] no player connected\n");
+        return -1;
+    }
+    c->fd = accept(listen_fd, NULL, NULL);
+    if (c->fd < 0) {
+        perror("[Server] accept failed");
+        return -1;
+    }
+    c->used = 0;
+    int status;
+    cJSON *msg = conn_recv(c, now_sec() + REGISTER_TIMEOUT, &status);
+    cJSON *tp = cJSON_GetObjectItemCaseSensitive(msg, "type");
+    cJSON *un = cJSON_GetObjectItemCaseSensitive(msg, "username");
+    if (!cJSON_IsString(tp) || strcmp(tp->valuestring, "register") != 0 ||
+        !cJSON_IsString(un)) {
+        fprintf(stderr, "[Server] bad register\n");
+        cJSON_Delete(msg);
+        close(c->fd);
+        return -1;
+    }
+    snprintf(c->name, sizeof(c->name), "%s", un->valuestring);
+    cJSON_Delete(msg);
+
+    cJSON *ack = cJSON_CreateObject();
+    cJSON_AddStringToObject(ack, "type", "register_ack");
+    conn_send(c, ack);
+    cJSON_Delete(ack);
+    return 0;
+}
+
+/* 두 명을 받아 한 게임을 끝까지 진행. 접속 실패면 -1 */
+static int run_game(int listen_fd, const GameConfig *cfg, GameResult *res)
+{
+    Conn conn[2];
+    if (accept_player(listen_fd, &conn[0]) < 0) return -1;
+    if (accept_player(listen_fd, &conn[1]) < 0) {
+        close(conn[0].fd);
+        return -1;
+    }
+    // conn[0] 이 R(선공)이 되도록
+    if (cfg->first && strcmp(conn[1].name, cfg->first) == 0) {
+        Conn tmp = conn[0];
+        conn[0] = conn[1];
+        conn[1] = tmp;
+    }
+
+    memset(res, 0, sizeof(*res));
+    res->forfeit = -1;
+    for (int i = 0; i < 2; ++i)
+        snprintf(res->name[i], sizeof(res->name[i]), "%s", conn[i].name);
+
+    cJSON *gs = cJSON_CreateObject();
+    cJSON_AddStringToObject(gs, "type", "game_start");
+    cJSON_AddStringToObject(gs, "first_player", conn[0].name);
+    cJSON *players = cJSON_AddArrayToObject(gs, "players");
+    cJSON_AddItemToArray(players, cJSON_CreateString(conn[0].name));
+    cJSON_AddItemToArray(players, cJSON_CreateString(conn[1].name));
+    for (int i = 0; i < 2; ++i) conn_send(&conn[i], gs);
+    cJSON_Delete(gs);
+
+    char bd[SIZE][SIZE];
+    memset(bd, '.', sizeof(bd));
+    bd[0][0] = bd[SIZE-1][SIZE-1] = 'R';
+    bd[0][SIZE-1] = bd[SIZE-1][0] = 'B';
+    int turn = 0;
+    random_opening(bd, cfg->open_plies, cfg->seed, &turn);
+
+    res->reason = "no moves";
+    for (int t = 0; ; ++t) {
+        char me = turn ? 'B' : 'R', opp = turn ? 'R' : 'B';
+        if (count_pieces(bd, me) == 0 || count_pieces(bd, opp) == 0) {
+            res->reason = "eliminated";
+            break;
+        }
+        int can_move = has_moves(bd, me);
+        if (!can_move && !has_moves(bd, opp)) break;
+        if (t >= MAX_TURNS) {
+            res->reason = "turn limit";
+            break;
+        }
+
+        cJSON *yt = cJSON_CreateObject();
+        cJSON_AddStringToObject(yt, "type", "your_turn");
+        cJSON_AddItemToObject(yt, "board", board_json(bd));
+        cJSON_AddNumberToObject(yt, "timeout", cfg->timeout);
+        double t0 = now_sec();
+        int sent = conn_send(&conn[turn], yt);
+        cJSON_Delete(yt);
+
+        int status = RECV_CLOSED;
+        cJSON *mv = NULL;
+        const char *reason = NULL;
+        // 다른 메시지는 건너뛰고 move 를 기다린다
+        while (sent == 0) {
+            mv = conn_recv(&conn[turn], t0 + cfg->timeout + cfg->grace, &status);
+            if (!mv) break;
+            cJSON *tp = cJSON_GetObjectItemCaseSensitive(mv, "type");
+            if (cJSON_IsString(tp) && strcmp(tp->valuestring, "move") == 0) break;
+            cJSON_Delete(mv);
+            mv = NULL;
+        }
+        res->think[turn] += now_sec() - t0;
+
+        if (!mv) {
+            reason = status == RECV_TIMEOUT ? "timeout" : "disconnected";
+            if (cfg->verbose)
+                printf("[Server] %s %s after %.3fs\n", conn[turn].name, reason,
+                       now_sec() - t0);
+        } else {
+            int v[4];
+            const char *keys[4] = { "sx", "sy", "tx", "ty" };
+            for (int k = 0; k < 4; ++k) {
+                cJSON *j = cJSON_GetObjectItemCaseSensitive(mv, keys[k]);
+                v[k] = cJSON_IsNumber(j) ? j->valueint : -1;
+            }
+            cJSON_Delete(mv);
+            int pass = v[0] == 0 && v[1] == 0 && v[2] == 0 && v[3] == 0;
+            if (pass) {
+                if (can_move) reason = "illegal pass";
+            } else if (is_legal(bd, me, v[0] - 1, v[1] - 1, v[2] - 1, v[3] - 1)) {
+                apply_move(bd, me, v[0] - 1, v[1] - 1, v[2] - 1, v[3] - 1);
+                res->moves[turn]++;
+            } else {
+                reason = "illegal move";
+            }
+            if (cfg->verbose)
+                printf("[Server] %s %s (%d,%d)->(%d,%d) %.3fs\n", conn[turn].name,
+                       pass ? "pass" : reason ? "ILLEGAL" : "move",
+                       v[0], v[1], v[2], v[3], now_sec() - t0);
+        }
+        if (reason) {
+            res->forfeit = turn;
+            res->reason  = reason;
+            break;
+        }
+        turn ^= 1;
+    }
+
+    res->pieces[0] = count_pieces(bd, 'R');
+    res->pieces[1] = count_pieces(bd, 'B');
+
+    cJSON *go = cJSON_CreateObject();
+    cJSON_AddStringToObject(go, "type", "game_over");
+    cJSON *scores = cJSON_AddObjectToObject(go, "scores");
+    for (int i = 0; i < 2; ++i)
+        cJSON_AddNumberToObject(scores, conn[i].name, res->pieces[i]);
+    cJSON_AddStringToObject(go, "reason", res->reason);
+    for (int i = 0; i < 2; ++i) {
+        conn_send(&conn[i], go);
+        close(conn[i].fd);
+    }
+    cJSON_Delete(go);
+    return 0;
+}
+
+/* R 기준 결과: 1 승, 0 무, -1 패 */
+static int game_outcome(const GameResult *res)
+{
+    if (res->forfeit >= 0) return res->forfeit == 0 ? -1 : 1;
+    return (res->pieces[0] > res->pieces[1]) - (res->pieces[0] < res->pieces[1]);
+}
+
+/* 127.0.0.1:port 에서 대기, port 0 이면 빈 포트를 골라 *port 에 돌려준다 */
+static int listen_local(int *port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(*port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(fd, SOMAXCONN) < 0 ||    // 게임을 하나씩 돌리므로 다음 판 접속은 큐에서 기다린다
+        getsockname(fd, (struct sockaddr *)&addr, &len) < 0) {
+        close(fd);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+#ifndef OCTAFLIP_NO_MAIN     /* tournament 가 이 파일을 포함할 때 */
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s -port <port> [-timeout <sec>] [-grace <sec>]"
+            " [-games <N>] [-open-plies <N>] [-seed <S>] [-quiet]\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    int port = 0, games = 1;
+    GameConfig cfg = { 3.0, 0.5, 0, 1, NULL, 1 };
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-port") == 0) {
+            port = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-timeout") == 0) {
+            cfg.timeout = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-grace") == 0) {
+            cfg.grace = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-games") == 0) {
+            games = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-open-plies") == 0) {
+            cfg.open_plies = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-seed") == 0) {
+            cfg.seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-quiet") == 0) {
+            cfg.verbose = 0;
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (port <= 0 || cfg.timeout <= 0 || games < 1) usage(argv[0]);
+
+    int listen_fd = listen_local(&port);
+    if (listen_fd < 0) {
+        perror("[Server] listen failed");
+        exit(EXIT_FAILURE);
+    }
+    printf("[Server] listening on 127.0.0.1:%d\n", port);
+
+    for (int g = 0; g < games; ++g) {
+        GameResult res;
+        if (run_game(listen_fd, &cfg, &res) < 0) continue;
+        int out = game_outcome(&res);
+        printf("[Server] game %d: %s(R) %d - %d %s(B), %s, %s\n", g + 1,
+               res.name[0], res.pieces[0], res.pieces[1], res.name[1],
+               out > 0 ? "R wins" : out < 0 ? "B wins" : "draw", res.reason);
+        fflush(stdout);
+        cfg.seed++;
+    }
+    close(listen_fd);
+    return 0;
+}
+#endif /* OCTAFLIP_NO_MAIN */
@@ -0,0 +1,284 @@
+/********************************************************************
+ *  tournament.c ― 엔진 빌드 간 자체 대국 (로컬 서버 내장)
+ *
+ *  두 클라이언트 실행 파일을 여러 판 동시에 붙여 승률, Elo(95% 오차),
+ *  평균 탐색 깊이, 수당 생각 시간을 낸다.  판마다 빈 포트에 server.c 의
+ *  run_game 을 띄우고 클라이언트 두 개를 실행한다.
+ *    - 두 판씩 같은 무작위 시작 국면에서 선후를 바꿔 둔다
+ *    - 평균 깊이는 클라이언트 출력의 "[Client] depth N ..." 줄에서 읽는다
+ *
+ *  빌드:
+ *      gcc tournament.c cJSON.c -o tournament -O2 -Wall -Wextra -lm -pthread
+ *
+ *  실행 예:
+ *      ./tournament -a ./client_new -b ./client_old -games 200 -jobs 8
+ *                   -timeout 1.0 -open-plies 4 [-aargs "-threads 1"] [-bargs ".."]
+ *******************************************************************/
+
+#define OCTAFLIP_NO_MAIN
+#include "server.c"
+
+#include <math.h>
+#include <signal.h>
+#include <spawn.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/wait.h>
+
+#define MAX_EXTRA_ARGS 16
+
+extern char **environ;
+
+typedef struct {
+    const char *label;              /* "A" / "B" — 접속 이름으로도 쓴다 */
+    const char *path;
+    char       *extra[MAX_EXTRA_ARGS];
+    int         nextra;
+} Engine;
+
+/* A 기준 누적 결과 */
+typedef struct {
+    int    games, wins, losses, draws;
+    int    forfeits[2];             /* [0]=A, [1]=B */
+    long   depth_sum[2], depth_cnt[2];
+    long   moves[2];
+    double think[2];
+} Totals;
+
+static Engine          engines[2];
+static GameConfig      base_cfg = { 1.0, 0.5, 4, 1, NULL, 0 };
+static int             total_games = 100;
+static atomic_int      next_game;
+static Totals          totals;
+static pthread_mutex_t totals_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* "-threads 1 -hash 16" → 공백으로 나눈 인자들 */
+static void split_args(Engine *e, char *s)
+{
+    for (char *tok = strtok(s, " "); tok && e->nextra < MAX_EXTRA_ARGS;
+         tok = strtok(NULL, " "))
+        e->extra[e->nextra++] = tok;
+}
+
+/* 클라이언트 실행, stdout/stderr 는 out_fd 로 */
+static pid_t spawn_engine(const Engine *e, int port, int out_fd)
+{
+    char port_s[16];
+    snprintf(port_s, sizeof(port_s), "%d", port);
+    char *argv[8 + MAX_EXTRA_ARGS];
+    int n = 0;
+    argv[n++] = (char *)e->path;
+    argv[n++] = "-ip";       argv[n++] = "127.0.0.1";
+    argv[n++] = "-port";     argv[n++] = port_s;
+    argv[n++] = "-username"; argv[n++] = (char *)e->label;
+    for (int i = 0; i < e->nextra; ++i) argv[n++] = e->extra[i];
+    argv[n] = NULL;
+
+    posix_spawn_file_actions_t fa;
+    posix_spawn_file_actions_init(&fa);
+    posix_spawn_file_actions_adddup2(&fa, out_fd, STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&fa, out_fd, STDERR_FILENO);
+    pid_t pid;
+    int rc = posix_spawn(&pid, e->path, &fa, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&fa);
+    return rc == 0 ? pid : -1;
+}
+
+/* 게임이 끝났는데 안 나가면 잠시 기다렸다가 죽인다 */
+static void reap(pid_t pid)
+{
+    if (pid <= 0) return;
+    for (int i = 0; i < 200; ++i) {
+        if (waitpid(pid, NULL, WNOHANG) == pid) return;
+        nanosleep(&(struct timespec){ 0, 10 * 1000 * 1000 }, NULL);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+}
+
+/* 클라이언트 출력에서 "[Client] depth N" 줄의 N 을 모은다 */
+static void scan_depths(int fd, long *sum, long *cnt)
+{
+    FILE *fp = fdopen(fd, "r");
+    if (!fp) {
+        close(fd);
+        return;
+    }
+    rewind(fp);
+    char line[512];
+    int d;
+    while (fgets(line, sizeof(line), fp)) {
+        const char *p = strstr(line, "] depth ");
+        if (p && sscanf(p, "] depth %d", &d) == 1) {
+            *sum += d;
+            ++*cnt;
+        }
+    }
+    fclose(fp);
+}
+
+static void *game_worker(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        int g = atomic_fetch_add(&next_game, 1);
+        if (g >= total_games) break;
+
+        int port = 0;
+        int listen_fd = listen_local(&port);
+        if (listen_fd < 0) {
+            perror("[Tournament] listen failed");
+            continue;
+        }
+
+        // 두 판이 한 쌍: 같은 시작 국면, 선후만 바꾼다
+        GameConfig cfg = base_cfg;
+        cfg.seed  = base_cfg.seed + g / 2;
+        cfg.first = engines[g & 1].label;
+
+        int out[2];
+        pid_t pid[2];
+        for (int i = 0; i < 2; ++i) {
+            char path[] = "/tmp/octaflip_tourXXXXXX";
+            out[i] = mkstemp(path);
+            if (out[i] >= 0) unlink(path);
+            pid[i] = out[i] >= 0 ? spawn_engine(&engines[i], port, out[i]) : -1;
+        }
+
+        GameResult res;
+        int ok = pid[0] > 0 && pid[1] > 0 && run_game(listen_fd, &cfg, &res) == 0;
+        close(listen_fd);
+        for (int i = 0; i < 2; ++i) reap(pid[i]);
+
+        long dsum[2] = { 0, 0 }, dcnt[2] = { 0, 0 };
+        for (int i = 0; i < 2; ++i)
+            if (out[i] >= 0) scan_depths(out[i], &dsum[i], &dcnt[i]);
+        if (!ok) {
+            fprintf(stderr, "[Tournament] game %d: could not start\n", g + 1);
+            continue;
+        }
+
+        // res 의 [0]/[1] 은 R/B, 엔진 A 가 어느 쪽인지 찾는다
+        int a_side = strcmp(res.name[0], engines[0].label) == 0 ? 0 : 1;
+        int out_r = game_outcome(&res);
+        int out_a = a_side == 0 ? out_r : -out_r;
+
+        pthread_mutex_lock(&totals_lock);
+        totals.games++;
+        if      (out_a > 0) totals.wins++;
+        else if (out_a < 0) totals.losses++;
+        else                totals.draws++;
+        if (res.forfeit >= 0) totals.forfeits[res.forfeit == a_side ? 0 : 1]++;
+        for (int i = 0; i < 2; ++i) {
+            int side = i == 0 ? a_side : a_side ^ 1;
+            totals.depth_sum[i] += dsum[i];
+            totals.depth_cnt[i] += dcnt[i];
+            totals.moves[i]     += res.moves[side];
+            totals.think[i]     += res.think[side];
+        }
+        printf("[Tournament] game %3d: A(%c) %2d - %2d B, %s, %s  (A %d-%d-%d)\n",
+               g + 1, a_side == 0 ? 'R' : 'B',
+               res.pieces[a_side], res.pieces[a_side ^ 1],
+               out_a > 0 ? "A wins" : out_a < 0 ? "B wins" : "draw", res.reason,
+               totals.wins, totals.losses, totals.draws);
+        fflush(stdout);
+        pthread_mutex_unlock(&totals_lock);
+    }
+    return NULL;
+}
+
+/* 점수율 → Elo 차 */
+static double elo_of(double score)
+{
+    if (score <= 0) return -INFINITY;
+    if (score >= 1) return INFINITY;
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+static void report(void)
+{
+    const Totals *t = &totals;
+    if (t->games == 0) {
+        puts("[Tournament] no games finished");
+        return;
+    }
+    int n = t->games;
+    double score = (t->wins + 0.5 * t->draws) / n;
+    // 판별 점수(1, 0.5, 0)의 분산으로 표준오차, 95% 구간을 Elo 로 옮긴다
+    double sq  = (t->wins + 0.25 * t->draws) / n;
+    double se  = sqrt(fmax(sq - score * score, 0) / n);
+    double lo  = elo_of(score - 1.96 * se), hi = elo_of(score + 1.96 * se);
+
+    printf("\nGames %d: A %d wins, %d losses, %d draws (score %.1f%%)\n",
+           n, t->wins, t->losses, t->draws, score * 100);
+    printf("Elo A - B: %+.1f  (95%%: %+.1f .. %+.1f, ±%.1f)\n",
+           elo_of(score), lo, hi, (hi - lo) / 2);
+    for (int i = 0; i < 2; ++i) {
+        printf("%s %-24s avg depth %5.2f  time/move %.3f s  forfeits %d\n",
+               engines[i].label, engines[i].path,
+               t->depth_cnt[i] ? (double)t->depth_sum[i] / t->depth_cnt[i] : 0.0,
+               t->moves[i] ? t->think[i] / t->moves[i] : 0.0,
+               t->forfeits[i]);
+    }
+}
+
+static void tour_usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s -a <client> -b <client> [-aargs \"..\"] [-bargs \"..\"]"
+            " [-games <N>] [-jobs <N>] [-timeout <sec>] [-grace <sec>]"
+            " [-open-plies <N>] [-seed <S>]\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int jobs = ncpu > 0 ? (int)ncpu : 1;
+    engines[0].label = "A";
+    engines[1].label = "B";
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-a") == 0) {
+            engines[0].path = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-b") == 0) {
+            engines[1].path = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-aargs") == 0) {
+            split_args(&engines[0], argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-bargs") == 0) {
+            split_args(&engines[1], argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-games") == 0) {
+            total_games = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-jobs") == 0) {
+            jobs = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-timeout") == 0) {
+            base_cfg.timeout = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-grace") == 0) {
+            base_cfg.grace = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-open-plies") == 0) {
+            base_cfg.open_plies = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-seed") == 0) {
+            base_cfg.seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else {
+            tour_usage(argv[0]);
+        }
+    }
+    if (!engines[0].path || !engines[1].path || total_games < 1 || jobs < 1 ||
+        base_cfg.timeout <= 0)
+        tour_usage(argv[0]);
+    if (jobs > total_games) jobs = total_games;
+
+    printf("[Tournament] %d games, %d jobs, timeout %.2f s, %d opening plies\n",
+           total_games, jobs, base_cfg.timeout, base_cfg.open_plies);
+
+    pthread_t *tids = malloc(jobs * sizeof(pthread_t));
+    if (!tids) exit(EXIT_FAILURE);
+    for (int j = 0; j < jobs; ++j)
+        pthread_create(&tids[j], NULL, game_worker, NULL);
+    for (int j = 0; j < jobs; ++j)
+        pthread_join(tids[j], NULL);
+    free(tids);
+
+    report();
+    return 0;
+}